@@ -28,11 +28,13 @@ ApplicationState applicationState;
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
-// This section defines the callbacks for our button press events (implemented at bottom).
-// Add any other callbacks you may need either here or in another file.
-void cb_light_pressed();
-void cb_mode_pressed();
-void cb_alarm_pressed();
+// This section defines the handlers for our button press events (implemented at bottom).
+// Add any other handlers you may need either here or in another file.
+void light_pressed();
+void mode_pressed();
+void alarm_pressed();
+void update_led();
+void update_text();
 
 
 //////////////////////////////////////////////////////////////////////////////////////////
@@ -76,11 +78,13 @@ void app_setup() {
     watch_enable_led(false); // enable LED with plain digital IO, not PWM
 
     watch_enable_buttons();
-    watch_register_button_callback(BTN_LIGHT, cb_light_pressed);
-    watch_register_button_callback(BTN_MODE, cb_mode_pressed);
-    watch_register_button_callback(BTN_ALARM, cb_alarm_pressed);
+    watch_register_button_event(BTN_LIGHT);
+    watch_register_button_event(BTN_MODE);
+    watch_register_button_event(BTN_ALARM);
 
     watch_enable_display();
+    update_led();
+    update_text();
 }
 
 /**
@@ -100,11 +104,60 @@ void app_wake_from_sleep() {
     applicationState.wake_count++;
 }
 
+/**
+ * @brief the app_handle_event function is called once for each event that arrived since
+ * the last pass through the run loop, before app_loop. Events are queued by interrupts,
+ * so this is where you respond to button presses without racing the interrupt handlers.
+ */
+void app_handle_event(watch_event_t event) {
+    if (event.type != WATCH_EVENT_BUTTON) return;
+
+    switch (event.button) {
+        case BTN_LIGHT:
+            light_pressed();
+            break;
+        case BTN_MODE:
+            mode_pressed();
+            break;
+        case BTN_ALARM:
+            alarm_pressed();
+            break;
+    }
+}
+
 /**
  * @brief the app_loop function is called once on app startup and then again each time
  * the watch STANDBY sleep mode.
  */
 bool app_loop() {
+    // Display the number of times we've woken up (modulo 32 to fit in 2 digits at top right)
+    char buf[3] = {0};
+    sprintf(buf, "%2d", applicationState.wake_count % 32);
+    watch_display_string(buf, 2);
+    watch_display_commit();
+
+    return true;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Implementations for our event handlers. Replace these with whatever functionality
+// your app requires.
+void light_pressed() {
+    applicationState.color = (applicationState.color + 1) % 4;
+    update_led();
+}
+
+void mode_pressed() {
+    applicationState.mode = (applicationState.mode + 1) % 2;
+    update_text();
+}
+
+void alarm_pressed() {
+    // TODO: deep sleep demo
+}
+
+void update_led() {
     // set the LED to a color
     switch (applicationState.color) {
         case COLOR_RED:
@@ -120,12 +173,9 @@ bool app_loop() {
             applicationState.color = COLOR_OFF;
             watch_set_led_off();
     }
+}
 
-    // Display the number of times we've woken up (modulo 32 to fit in 2 digits at top right)
-    char buf[3] = {0};
-    sprintf(buf, "%2d", applicationState.wake_count % 32);
-    watch_display_string(buf, 2);
-
+void update_text() {
     // display "Hello there" text
     switch (applicationState.mode) {
         case MODE_HELLO:
@@ -135,25 +185,4 @@ bool app_loop() {
             watch_display_string("there", 5);
             break;
     }
-
-    // Wait a moment to debounce button input
-    delay_ms(250);
-
-    return true;
-}
-
-
-//////////////////////////////////////////////////////////////////////////////////////////
-// Implementations for our callback functions. Replace these with whatever functionality
-// your app requires.
-void cb_light_pressed() {
-    applicationState.color = (applicationState.color + 1) % 4;
-}
-
-void cb_mode_pressed() {
-    applicationState.mode = (applicationState.mode + 1) % 2;
 }
-
-void cb_alarm_pressed() {
-    // TODO: deep sleep demo
-}
\ No newline at end of file
@@ -0,0 +1,198 @@
+#!/usr/bin/env python3
+"""Generates the segment mask tables used by watch_display_character().
+
+For every character position and every printable character, the tables hold the bits
+to clear and the bits to set in each SDATA word the position touches, so drawing a
+character is a few word operations at run time instead of walking the segment map.
+"""
+import argparse
+
+# Segments lit for each character from ' ' (0x20) to '~' (0x7e). Bit 0 is segment A,
+# bit 1 is segment B, and so on through bit 7.
+CHARACTER_SET = [
+    0b00000000, # space
+    0b00000000, # !
+    0b00100010, # "
+    0b00000000, # #
+    0b00000000, # $
+    0b00000000, # %
+    0b01000100, # &
+    0b00100000, # '
+    0b00000000, # (
+    0b00000000, # )
+    0b00000000, # *
+    0b11000000, # +
+    0b00010000, # ,
+    0b01000000, # -
+    0b00000100, # .
+    0b00010010, # /
+    0b00111111, # 0
+    0b00000110, # 1
+    0b01011011, # 2
+    0b01001111, # 3
+    0b01100110, # 4
+    0b01101101, # 5
+    0b01111101, # 6
+    0b00000111, # 7
+    0b01111111, # 8
+    0b01101111, # 9
+    0b00000000, # :
+    0b00000000, # ;
+    0b01011000, # <
+    0b01001000, # =
+    0b01001100, # >
+    0b01010011, # ?
+    0b11111111, # @
+    0b01110111, # A
+    0b01111111, # B
+    0b00111001, # C
+    0b00111111, # D
+    0b01111001, # E
+    0b01110001, # F
+    0b00111101, # G
+    0b01110110, # H
+    0b10001001, # I
+    0b00001110, # J
+    0b11101010, # K
+    0b00111000, # L
+    0b10110111, # M
+    0b00110111, # N
+    0b00111111, # O
+    0b01110011, # P
+    0b01100111, # Q
+    0b11110111, # R
+    0b01101101, # S
+    0b10000001, # T
+    0b00111110, # U
+    0b00111110, # V
+    0b10111110, # W
+    0b01111110, # X
+    0b01101110, # Y
+    0b00011011, # Z
+    0b00111001, # [
+    0b00100100, # backslash
+    0b00001111, # ]
+    0b00100110, # ^
+    0b00001000, # _
+    0b00000010, # `
+    0b01011111, # a
+    0b01111100, # b
+    0b01011000, # c
+    0b01011110, # d
+    0b01111011, # e
+    0b01110001, # f
+    0b01101111, # g
+    0b01110100, # h
+    0b00010000, # i
+    0b01000010, # j
+    0b11101010, # k
+    0b00110000, # l
+    0b10110111, # m
+    0b01010100, # n
+    0b01011100, # o
+    0b01110011, # p
+    0b01100111, # q
+    0b01010000, # r
+    0b01101101, # s
+    0b01111000, # t
+    0b01100010, # u
+    0b01100010, # v
+    0b10111110, # w
+    0b01111110, # x
+    0b01101110, # y
+    0b00011011, # z
+    0b00111001, # {
+    0b00110000, # |
+    0b00001111, # }
+    0b00000001, # ~
+]
+
+# One byte per segment of each position, segment A in the low byte. The top two bits of
+# each byte are the COM line and the low six bits are the SEG line; COM 3 means the
+# position has no such segment.
+SEGMENT_MAP = [
+    0x4e4f0e8e8f8d4d0d, # Position 8
+    0x0c8c4c4c8b4b4b0b, # Position 9
+    0xc049c00a49890949, # Position 6
+    0xc048088886874707, # Position 7
+    0xc053921252139352, # Position 0
+    0xc054511415559594, # Position 1
+    0xc057965616179716, # Position 2
+    0xc041804000018a81, # Position 3
+    0xc043420203048382, # Position 4
+    0xc045440506468584, # Position 5
+]
+
+SDATA_WORDS_PER_COM = 2
+
+
+def segments(position):
+    segmap = SEGMENT_MAP[position]
+    for segment in range(8):
+        byte = (segmap >> (segment * 8)) & 0xff
+        com = byte >> 6
+        if com > 2:
+            continue
+        yield segment, com, byte & 0x3f
+
+
+def sdata_word(com, seg):
+    return com * SDATA_WORDS_PER_COM + (seg >> 5)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate SDATA segment mask tables.')
+    parser.add_argument('output', metavar='OUTPUT', type=str, help='header to write')
+    args = parser.parse_args()
+
+    words = sorted({sdata_word(com, seg) for position in range(len(SEGMENT_MAP))
+                    for _, com, seg in segments(position)})
+
+    def masks(position, glyph):
+        result = [0] * len(words)
+        # Some positions map two segments to the same pixel; the later segment wins.
+        for segment, com, seg in segments(position):
+            bit = 1 << (seg & 0x1f)
+            word = words.index(sdata_word(com, seg))
+            result[word] &= ~bit
+            if glyph & (1 << segment):
+                result[word] |= bit
+        return result
+
+    lines = [
+        '// Generated by utils/segment_masks.py; do not edit.',
+        '#ifndef WATCH_SEGMENT_MASKS_H_',
+        '#define WATCH_SEGMENT_MASKS_H_',
+        '',
+        '#define SEGMENT_MASK_NUM_POSITIONS %d' % len(SEGMENT_MAP),
+        '#define SEGMENT_MASK_NUM_CHARACTERS %d' % len(CHARACTER_SET),
+        '#define SEGMENT_MASK_NUM_WORDS %d' % len(words),
+        '',
+        '// Index of each SDATA word (SDATAL0, SDATAH0, SDATAL1, ...) the masks below apply to.',
+        'static const uint8_t Segment_Mask_Words[SEGMENT_MASK_NUM_WORDS] = {%s};' % ', '.join(str(w) for w in words),
+        '',
+        '// Every segment of each position, for clearing it before drawing a new character.',
+        'static const uint32_t Position_Masks[SEGMENT_MASK_NUM_POSITIONS][SEGMENT_MASK_NUM_WORDS] = {',
+    ]
+    for position in range(len(SEGMENT_MAP)):
+        mask = masks(position, 0xff)
+        lines.append('    {%s},' % ', '.join('0x%08x' % m for m in mask))
+    lines += [
+        '};',
+        '',
+        '// Segments to light for each character at each position.',
+        'static const uint32_t Character_Masks[SEGMENT_MASK_NUM_POSITIONS][SEGMENT_MASK_NUM_CHARACTERS][SEGMENT_MASK_NUM_WORDS] = {',
+    ]
+    for position in range(len(SEGMENT_MAP)):
+        lines.append('    {')
+        for glyph in CHARACTER_SET:
+            lines.append('        {%s},' % ', '.join('0x%08x' % m for m in masks(position, glyph)))
+        lines.append('    },')
+    lines += ['};', '', '#endif /* WATCH_SEGMENT_MASKS_H_ */', '']
+
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,152 @@
+#!/usr/bin/env python3
+"""Decodes the tokenized trace records in a debug log capture.
+
+WATCH_TRACE() (see watch-library/watch/watch_trace.h) sends the address of its format string
+in the ELF's .watch_trace section and its arguments as varints, instead of formatted text. This
+reads the format strings back out of the firmware's ELF and prints each record as the text it
+stands for; anything else in the capture, such as watch_log_printf() output, passes through.
+
+    python3 utils/trace_decode.py build/watch.elf capture.bin
+    cat /dev/ttyACM0 | python3 utils/trace_decode.py build/watch.elf
+"""
+import argparse
+import re
+import struct
+import sys
+
+TRACE_SECTION = '.watch_trace'
+TRACE_MARKER = 0xFF
+
+# A printf conversion: flags, width, precision and length modifiers, then the conversion.
+CONVERSION = re.compile(r'%([-+ #0]*)(\d*)(?:\.(\d+))?(?:hh|h|ll|l|z|j|t)?([diuxXoc%])')
+
+
+def read_trace_section(path):
+    """Returns the address and contents of the trace section of an ELF file."""
+    with open(path, 'rb') as f:
+        elf = f.read()
+    if elf[:4] != b'\x7fELF':
+        raise ValueError('%s is not an ELF file' % path)
+    is64 = elf[4] == 2
+    endian = '<' if elf[5] == 1 else '>'
+    if is64:
+        shoff, = struct.unpack_from(endian + 'Q', elf, 0x28)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', elf, 0x3A)
+        header = endian + 'IIQQQQIIQQ'
+    else:
+        shoff, = struct.unpack_from(endian + 'I', elf, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from(endian + 'HHH', elf, 0x2E)
+        header = endian + 'IIIIIIIIII'
+
+    sections = [struct.unpack_from(header, elf, shoff + i * shentsize) for i in range(shnum)]
+    names = sections[shstrndx]
+    for name, _, _, addr, offset, size, _, _, _, _ in sections:
+        start = names[4] + name
+        if elf[start:elf.index(b'\0', start)].decode() == TRACE_SECTION:
+            return addr, elf[offset:offset + size]
+    raise ValueError('%s has no %s section; was it built with WATCH_TRACE?' % (path, TRACE_SECTION))
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, pos
+
+
+def format_message(fmt, args):
+    """Formats a C printf format string with 32-bit integer arguments."""
+    args = list(args)
+
+    def convert(match):
+        flags, width, precision, conversion = match.groups()
+        if conversion == '%':
+            return '%'
+        if not args:
+            return '<missing>'
+        value = args.pop(0)
+        if conversion in 'di':
+            value = value - (1 << 32) if value & 0x80000000 else value
+            conversion = 'd'
+        elif conversion == 'u':
+            conversion = 'd'
+        elif conversion == 'c':
+            value = chr(value & 0xFF)
+        spec = '%' + flags + width + ('.' + precision if precision else '') + conversion
+        return spec % value
+
+    return CONVERSION.sub(convert, fmt)
+
+
+class Decoder:
+    def __init__(self, base, strings):
+        self.base = base
+        self.strings = strings
+
+    def lookup(self, token):
+        offset = token - self.base
+        if offset < 0 or offset >= len(self.strings):
+            return None
+        end = self.strings.find(b'\0', offset)
+        return self.strings[offset:end].decode('utf-8', 'replace')
+
+    def record(self, payload):
+        token, pos = read_varint(payload, 0)
+        args = []
+        while pos < len(payload):
+            value, pos = read_varint(payload, pos)
+            args.append(value)
+        fmt = self.lookup(token)
+        if fmt is None:
+            return '<unknown trace 0x%x: %s>' % (token, ' '.join(str(a) for a in args))
+        return format_message(fmt, args).rstrip('\n')
+
+    def decode(self, stream, out):
+        """Copies text from stream to out, replacing each trace record with its message."""
+        text_pending = False
+        while True:
+            byte = stream.read(1)
+            if not byte:
+                break
+            if byte[0] != TRACE_MARKER:
+                out.write(byte.decode('latin-1'))
+                text_pending = byte != b'\n'
+                continue
+            length = stream.read(1)
+            payload = stream.read(length[0]) if length else b''
+            if not length or len(payload) < length[0]:
+                out.write('<truncated trace record>\n')
+                break
+            if text_pending:
+                out.write('\n')
+                text_pending = False
+            try:
+                out.write(self.record(payload) + '\n')
+            except IndexError:
+                out.write('<malformed trace record: %s>\n' % payload.hex())
+            out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode WATCH_TRACE records in a debug log capture.')
+    parser.add_argument('elf', metavar='ELF', type=str, help='firmware the capture came from')
+    parser.add_argument('capture', metavar='CAPTURE', type=str, nargs='?',
+                        help='raw bytes from the UART (default: standard input)')
+    args = parser.parse_args()
+
+    base, strings = read_trace_section(args.elf)
+    decoder = Decoder(base, strings)
+    if args.capture:
+        with open(args.capture, 'rb') as stream:
+            decoder.decode(stream, sys.stdout)
+    else:
+        decoder.decode(sys.stdin.buffer, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -12,7 +12,9 @@
   * 3. Your app_setup() method is called.
   *      - You may wish to enable some functionality and peripherals here.
   *      - You should definitely set up some interrupts here.
-  * 4. The main run loop begins: your app_loop() function is called.
+  * 4. The main run loop begins. Each event queued by an interrupt is passed to your
+  *    app_handle_event() function, and then your app_loop() function is called.
+  *      - Respond to button presses, ticks and wakes in app_handle_event().
   *      - Run code and update your UI here.
   *      - Return true if your app is prepared to enter STANDBY mode.
   * 5. This step differs depending on the value returned by app_loop:
@@ -28,6 +30,7 @@
 void app_init();
 void app_wake_from_deep_sleep();
 void app_setup();
+void app_handle_event(watch_event_t event);
 bool app_loop();
 void app_prepare_for_sleep();
 void app_wake_from_sleep();
@@ -271,7 +271,7 @@
 // <i> Indicates whether the external interrupt 5 filter is enabled or not
 // <id> eic_arch_filten5
 #ifndef CONF_EIC_FILTEN5
-#define CONF_EIC_FILTEN5 0
+#define CONF_EIC_FILTEN5 1
 #endif
 
 // <q> External Interrupt 5 Event Output Enable
@@ -291,7 +291,7 @@
 // <i> This defines input sense trigger
 // <id> eic_arch_sense5
 #ifndef CONF_EIC_SENSE5
-#define CONF_EIC_SENSE5 EIC_NMICTRL_NMISENSE_RISE_Val
+#define CONF_EIC_SENSE5 EIC_NMICTRL_NMISENSE_BOTH_Val
 #endif
 
 // <q> External Interrupt 5 Asynchronous Edge Detection Mode
@@ -313,7 +313,7 @@
 // <i> Indicates whether the external interrupt 6 filter is enabled or not
 // <id> eic_arch_filten6
 #ifndef CONF_EIC_FILTEN6
-#define CONF_EIC_FILTEN6 0
+#define CONF_EIC_FILTEN6 1
 #endif
 
 // <q> External Interrupt 6 Event Output Enable
@@ -333,7 +333,7 @@
 // <i> This defines input sense trigger
 // <id> eic_arch_sense6
 #ifndef CONF_EIC_SENSE6
-#define CONF_EIC_SENSE6 EIC_NMICTRL_NMISENSE_RISE_Val
+#define CONF_EIC_SENSE6 EIC_NMICTRL_NMISENSE_BOTH_Val
 #endif
 
 // <q> External Interrupt 6 Asynchronous Edge Detection Mode
@@ -355,7 +355,7 @@
 // <i> Indicates whether the external interrupt 7 filter is enabled or not
 // <id> eic_arch_filten7
 #ifndef CONF_EIC_FILTEN7
-#define CONF_EIC_FILTEN7 0
+#define CONF_EIC_FILTEN7 1
 #endif
 
 // <q> External Interrupt 7 Event Output Enable
@@ -375,7 +375,7 @@
 // <i> This defines input sense trigger
 // <id> eic_arch_sense7
 #ifndef CONF_EIC_SENSE7
-#define CONF_EIC_SENSE7 EIC_NMICTRL_NMISENSE_RISE_Val
+#define CONF_EIC_SENSE7 EIC_NMICTRL_NMISENSE_BOTH_Val
 #endif
 
 // <q> External Interrupt 7 Asynchronous Edge Detection Mode
@@ -136,7 +136,7 @@
 // <i> Indicates whether Run in Standby is enabled or not
 // <id> osc16m_arch_runstdby
 #ifndef CONF_OSC16M_RUNSTDBY
-#define CONF_OSC16M_RUNSTDBY 0
+#define CONF_OSC16M_RUNSTDBY 1
 #endif
 
 // <y> Oscillator Frequency Selection(Mhz)
@@ -39,6 +39,18 @@
 
 #endif
 
+// <o> Reference year <1968-2104>
+// <i> The RTC runs in clock/calendar mode (MODE2); its 6-bit YEAR field counts years from
+// <i> this one. Must be a leap year, since the RTC treats every year divisible by 4 as one.
+// <id> rtc_reference_year
+#ifndef CONF_RTC_REFERENCE_YEAR
+#define CONF_RTC_REFERENCE_YEAR 2020
+#endif
+
+#if CONF_RTC_REFERENCE_YEAR & 3
+#error CONF_RTC_REFERENCE_YEAR must be a leap year
+#endif
+
 #ifndef CONF_RTC_COMP_VAL
 
 #define CONF_RTC_COMP_VAL 0
@@ -243,56 +255,56 @@
 // <e> Event control
 // <id> rtc_event_control
 #ifndef CONF_RTC_EVENT_CONTROL_ENABLE
-#define CONF_RTC_EVENT_CONTROL_ENABLE 0
+#define CONF_RTC_EVENT_CONTROL_ENABLE 1
 #endif
 
 // <q> Periodic Interval 0 Event Output
 // <i> This bit indicates whether Periodic interval 0 event is enabled and will be generated
 // <id> rtc_pereo0
 #ifndef CONF_RTC_PEREO0
-#define CONF_RTC_PEREO0 0
+#define CONF_RTC_PEREO0 1
 #endif
 // <q> Periodic Interval 1 Event Output
 // <i> This bit indicates whether Periodic interval 1 event is enabled and will be generated
 // <id> rtc_pereo1
 #ifndef CONF_RTC_PEREO1
-#define CONF_RTC_PEREO1 0
+#define CONF_RTC_PEREO1 1
 #endif
 // <q> Periodic Interval 2 Event Output
 // <i> This bit indicates whether Periodic interval 2 event is enabled and will be generated
 // <id> rtc_pereo2
 #ifndef CONF_RTC_PEREO2
-#define CONF_RTC_PEREO2 0
+#define CONF_RTC_PEREO2 1
 #endif
 // <q> Periodic Interval 3 Event Output
 // <i> This bit indicates whether Periodic interval 3 event is enabled and will be generated
 // <id> rtc_pereo3
 #ifndef CONF_RTC_PEREO3
-#define CONF_RTC_PEREO3 0
+#define CONF_RTC_PEREO3 1
 #endif
 // <q> Periodic Interval 4 Event Output
 // <i> This bit indicates whether Periodic interval 4 event is enabled and will be generated
 // <id> rtc_pereo4
 #ifndef CONF_RTC_PEREO4
-#define CONF_RTC_PEREO4 0
+#define CONF_RTC_PEREO4 1
 #endif
 // <q> Periodic Interval 5 Event Output
 // <i> This bit indicates whether Periodic interval 5 event is enabled and will be generated
 // <id> rtc_pereo5
 #ifndef CONF_RTC_PEREO5
-#define CONF_RTC_PEREO5 0
+#define CONF_RTC_PEREO5 1
 #endif
 // <q> Periodic Interval 6 Event Output
 // <i> This bit indicates whether Periodic interval 6 event is enabled and will be generated
 // <id> rtc_pereo6
 #ifndef CONF_RTC_PEREO6
-#define CONF_RTC_PEREO6 0
+#define CONF_RTC_PEREO6 1
 #endif
 // <q> Periodic Interval 7 Event Output
 // <i> This bit indicates whether Periodic interval 7 event is enabled and will be generated
 // <id> rtc_pereo7
 #ifndef CONF_RTC_PEREO7
-#define CONF_RTC_PEREO7 0
+#define CONF_RTC_PEREO7 1
 #endif
 
 // <q> Compare 0 Event Output
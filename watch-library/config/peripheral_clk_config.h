@@ -19,7 +19,7 @@
 
 // <i> Select the clock source for ADC.
 #ifndef CONF_GCLK_ADC_SRC
-#define CONF_GCLK_ADC_SRC GCLK_PCHCTRL_GEN_GCLK0_Val
+#define CONF_GCLK_ADC_SRC GCLK_PCHCTRL_GEN_GCLK1_Val
 #endif
 
 /**
@@ -55,7 +55,8 @@ typedef void (*calendar_cb_alarm_t)(struct calendar_descriptor *const calendar);
 /** \brief Struct for alarm time
  */
 struct calendar_alarm {
-	struct list_element    elem;
+	/* position in calendar_descriptor::alarms while pending */
+	uint8_t                heap_index;
 	struct _calendar_alarm cal_alarm;
 	calendar_cb_alarm_t    callback;
 };
@@ -110,6 +111,7 @@ int32_t calendar_set_baseyear(struct calendar_descriptor *const calendar, const
  *  \param calendar Pointer to the HAL Calendar instance.
  *  \param p_calendar_time Pointer to the time configuration.
  *  \retval 0       Completed successfully.
+ *  \retval ERR_INVALID_ARG The time is outside the range the hardware calendar holds.
  */
 int32_t calendar_set_time(struct calendar_descriptor *const calendar, struct calendar_time *const p_calendar_time);
 
@@ -119,6 +121,7 @@ int32_t calendar_set_time(struct calendar_descriptor *const calendar, struct cal
  *  \param p_calendar_date Pointer to the date configuration.
  *  \return Operation status of time set.
  *  \retval 0       Completed successfully.
+ *  \retval ERR_INVALID_ARG The date is outside the range the hardware calendar holds.
  */
 int32_t calendar_set_date(struct calendar_descriptor *const calendar, struct calendar_date *const p_calendar_date);
 
@@ -141,10 +144,28 @@ int32_t calendar_get_date_time(struct calendar_descriptor *const calendar, struc
  *  \param callback Pointer to the callback function.
  *  \return Operation status of alarm time set.
  *  \retval 0       Completed successfully.
+ *  \retval ERR_NO_RESOURCE CALENDAR_MAX_ALARMS alarms are already pending.
  */
 int32_t calendar_set_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
                            calendar_cb_alarm_t callback);
 
+/** \brief Config a one-shot alarm at a counter value for calendar HAL instance
+ *
+ *  Like calendar_set_alarm() with a CALENDAR_ALARM_MATCH_YEAR one-shot alarm,
+ *  but takes the time as a counter value (seconds since the base year) instead
+ *  of a date/time.
+ *
+ *  \param calendar Pointer to the HAL Calendar instance.
+ *  \param alarm Pointer to the alarm; its cal_alarm fields are overwritten.
+ *  \param timestamp Counter value to fire at.
+ *  \param callback Pointer to the callback function; NULL removes the alarm.
+ *  \return Operation status of alarm time set.
+ *  \retval 0       Completed successfully.
+ *  \retval ERR_NO_RESOURCE CALENDAR_MAX_ALARMS alarms are already pending.
+ */
+int32_t calendar_set_alarm_at(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
+                              const uint32_t timestamp, calendar_cb_alarm_t callback);
+
 /** \brief Retrieve the current driver version
  *  \return Current driver version.
  */
@@ -121,12 +121,26 @@ struct calendar_date {
 	uint16_t year;
 };
 
+/** \brief Maximum number of alarms a calendar can have pending at once
+ */
+#ifndef CALENDAR_MAX_ALARMS
+#define CALENDAR_MAX_ALARMS 32
+#endif
+/* num_alarms and calendar_alarm::heap_index are eight bits wide */
+#if CALENDAR_MAX_ALARMS > 255
+#error CALENDAR_MAX_ALARMS must be 255 or less
+#endif
+
+struct calendar_alarm;
+
 /** \brief Calendar driver struct
  *
  */
 struct calendar_descriptor {
-	struct calendar_dev    device;
-	struct list_descriptor alarms;
+	struct calendar_dev device;
+	/* pending alarms as a binary min-heap on timestamp; alarms[0] is in the compare register */
+	struct calendar_alarm *alarms[CALENDAR_MAX_ALARMS];
+	uint8_t                num_alarms;
 	/*base date/time = base_year/1/1/0/0/0(year/month/day/hour/min/sec)*/
 	uint32_t base_year;
 	uint8_t  flags;
@@ -197,8 +211,18 @@ int32_t _calendar_disable(struct calendar_dev *const dev);
  * \param[in] counter The counter for set
  *
  * \return ERR_NONE on success, or an error code on failure.
+ * \retval ERR_INVALID_ARG The counter is outside the range the hardware calendar holds.
  */
 int32_t _calendar_set_counter(struct calendar_dev *const dev, const uint32_t counter);
+/**
+ * \brief Called by _calendar_set_counter() once the new counter is written
+ *
+ * The default implementation does nothing; code that keeps its own copy of the
+ * time overrides it to drop that copy.
+ *
+ * \param[in] dev The pointer to calendar device struct
+ */
+void _calendar_counter_written(struct calendar_dev *const dev);
 
 /**
  * \brief Get counter for calendar
@@ -214,10 +238,12 @@ uint32_t _calendar_get_counter(struct calendar_dev *const dev);
  *
  * \param[in] dev The pointer to calendar device struct
  * \param[in] comp The compare value for set
+ * \param[in] option The fields the compare matches on. With CALENDAR_ALARM_MATCH_SEC, _MIN
+ *                   or _HOUR it matches again every minute, hour or day without being set again.
  *
  * \return ERR_NONE on success, or an error code on failure.
  */
-int32_t _calendar_set_comp(struct calendar_dev *const dev, const uint32_t comp);
+int32_t _calendar_set_comp(struct calendar_dev *const dev, const uint32_t comp, const enum calendar_alarm_option option);
 
 /**
  * \brief Get compare value for calendar
@@ -248,6 +274,9 @@ void _calendar_set_irq(struct calendar_dev *const dev);
 /**
  * \brief Register callback for tamper detection
  *
+ * The callback also serves the periodic interval interrupts, which are chosen
+ * with _calendar_set_periodic_interrupts(). Passing NULL disables them all.
+ *
  * \param[in] dev The pointer to calendar device struct
  * \param[in] callback The pointer to callback function
  *
@@ -255,6 +284,20 @@ void _calendar_set_irq(struct calendar_dev *const dev);
  */
 int32_t _tamper_register_callback(struct calendar_dev *const dev, tamper_drv_cb_t callback_tamper);
 
+/**
+ * \brief Select the periodic interval interrupts that call the tamper callback
+ *
+ * Bit n of periods enables PERn, which fires at 128 >> n Hz; every other
+ * periodic interval interrupt is disabled. RTC_IRQn stays enabled while the
+ * alarm or any periodic interrupt is.
+ *
+ * \param[in] dev The pointer to calendar device struct
+ * \param[in] periods Bitmask of the PERn interrupts to enable
+ *
+ * \return ERR_NONE on success, or an error code on failure.
+ */
+int32_t _calendar_set_periodic_interrupts(struct calendar_dev *const dev, const uint8_t periods);
+
 /**
  * \brief Find tamper is detected on specified pin
  *
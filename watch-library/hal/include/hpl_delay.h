@@ -88,6 +88,18 @@ uint32_t _get_cycles_for_ms(const uint16_t ms);
  * \param[in] cycles The amount of cycles to delay for
  */
 void _delay_cycles(void *const hw, uint32_t cycles);
+
+/**
+ * \brief Wait for the given amount of us with the core asleep
+ *
+ * The default implementation declines; a driver that can wake the core after a set time
+ * overrides it.
+ *
+ * \param[in] us The amount of us to delay for
+ *
+ * \return true if the delay has been done, false if it should be done with _delay_cycles
+ */
+bool _delay_sleep_us(const uint32_t us);
 //@}
 
 #ifdef __cplusplus
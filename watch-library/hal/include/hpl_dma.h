@@ -112,6 +112,17 @@ int32_t _dma_set_source_address(const uint8_t channel, const void *const src);
  */
 int32_t _dma_set_next_descriptor(const uint8_t current_channel, const uint8_t next_channel);
 
+/**
+ * \brief Set next descriptor address to a descriptor outside the channel table
+ *
+ * \param[in] channel DMA channel to set next descriptor address
+ * \param[in] descriptor Next descriptor, 128-bit aligned in SRAM, or NULL to
+ *                       end the transfer after the first block
+ *
+ * \return setting status
+ */
+int32_t _dma_set_next_descriptor_address(const uint8_t channel, const void *const descriptor);
+
 /**
  * \brief Enable/disable source address incrementation during DMA transaction
  *
@@ -58,13 +58,14 @@ extern "C" {
  *
  * This function does low level external interrupt configuration.
  *
- * \param[in] cb The pointer to callback function from external interrupt
+ * \param[in] cb The pointer to callback function from external interrupt,
+ *                called with the number of the EXTINT line that fired
  *
  * \return Initialization status.
  * \retval -1 External irq module is already initialized
  * \retval 0 The initialization is completed successfully
  */
-int32_t _ext_irq_init(void (*cb)(const uint32_t pin));
+int32_t _ext_irq_init(void (*cb)(const uint8_t extint));
 
 /**
  * \brief Deinitialize external interrupt module
@@ -86,6 +87,15 @@ int32_t _ext_irq_deinit(void);
  * \retval 0 External irq module is enabled / disabled successfully
  */
 int32_t _ext_irq_enable(const uint32_t pin, const bool enable);
+
+/**
+ * \brief Retrieve the EXTINT line a pin is mapped to
+ *
+ * \param[in] pin Pin to look up
+ *
+ * \return The EXTINT line number, or -1 if the pin has no external interrupt
+ */
+int32_t _ext_irq_get_extint(const uint32_t pin);
 //@}
 
 #ifdef __cplusplus
@@ -79,6 +79,14 @@ void _reset_mcu(void);
  * \brief Put MCU to sleep
  */
 void _go_to_sleep(void);
+
+/**
+ * \brief Called by sleep() once the MCU is awake again
+ *
+ * The default implementation does nothing; code that keeps time on a clock the sleep
+ * may have stopped overrides it.
+ */
+void _sleep_exit(void);
 //@}
 
 #ifdef __cplusplus
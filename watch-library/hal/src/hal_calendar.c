@@ -122,76 +122,65 @@ static uint32_t get_secs_in_month(uint32_t year, uint8_t month)
 	return sec_in_month;
 }
 
+/* Days before the first of each month in a non-leap year, indexed by month (1..12).
+ * Index 13 is the whole year, which is what months past December add up to.
+ */
+static const uint16_t days_before_month[14] = {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334, 365};
+
+/** \brief count the leap years in [year, year + years)
+ */
+static uint32_t leap_years_between(uint32_t year, uint32_t years)
+{
+	/* Every year divisible by four is a leap year (see leap_year()). */
+	return (year + years + 3) / 4 - (year + 3) / 4;
+}
+
 /** \brief convert timestamp to date/time
  */
 static int32_t convert_timestamp_to_datetime(struct calendar_descriptor *const calendar, uint32_t ts,
                                              struct calendar_date_time *dt)
 {
-	uint32_t tmp, sec_in_year, sec_in_month;
-	uint32_t tmp_year    = calendar->base_year;
-	uint8_t  tmp_month   = 1;
-	uint8_t  tmp_day     = 1;
-	uint8_t  tmp_hour    = 0;
-	uint8_t  tmp_minutes = 0;
-
-	tmp = ts;
-
-	/* Find year */
-	while (true) {
-		sec_in_year = leap_year(tmp_year) ? SECS_IN_LEAP_YEAR : SECS_IN_NON_LEAP_YEAR;
-
-		if (tmp >= sec_in_year) {
-			tmp -= sec_in_year;
-			tmp_year++;
-		} else {
-			break;
-		}
+	uint32_t days     = ts / SECS_IN_DAY;
+	uint32_t secs     = ts % SECS_IN_DAY;
+	uint32_t offset   = calendar->base_year & 3;
+	uint32_t cycle_day, year, day_of_year, feb_end;
+	uint8_t  month;
+
+	/* Count days from the leap year at or before base_year, then split them into
+	 * four-year cycles of 1461 days, each starting with its leap year.
+	 */
+	days += offset * 365 + (offset ? 1 : 0);
+	cycle_day = days % 1461;
+	year      = calendar->base_year - offset + days / 1461 * 4;
+	if (cycle_day < 366) {
+		day_of_year = cycle_day;
+	} else {
+		year += (cycle_day - 1) / 365;
+		day_of_year = (cycle_day - 1) % 365;
 	}
-	/* Find month of year */
-	while (true) {
-		sec_in_month = get_secs_in_month(tmp_year, tmp_month);
 
-		if (tmp >= sec_in_month) {
-			tmp -= sec_in_month;
-			tmp_month++;
-		} else {
-			break;
-		}
-	}
-	/* Find day of month */
-	while (true) {
-		if (tmp >= SECS_IN_DAY) {
-			tmp -= SECS_IN_DAY;
-			tmp_day++;
-		} else {
-			break;
-		}
-	}
-	/* Find hour of day */
-	while (true) {
-		if (tmp >= SECS_IN_HOUR) {
-			tmp -= SECS_IN_HOUR;
-			tmp_hour++;
-		} else {
-			break;
-		}
-	}
-	/* Find minute in hour */
-	while (true) {
-		if (tmp >= SECS_IN_MINUTE) {
-			tmp -= SECS_IN_MINUTE;
-			tmp_minutes++;
-		} else {
-			break;
-		}
+	/* January and February directly; from March on, months follow a regular
+	 * 153-days-per-five-months pattern.
+	 */
+	feb_end = 59 + (leap_year(year) ? 1 : 0);
+	if (day_of_year < 31) {
+		month = 1;
+	} else if (day_of_year < feb_end) {
+		month = 2;
+		day_of_year -= 31;
+	} else {
+		day_of_year -= feb_end;
+		month = (5 * day_of_year + 2) / 153;
+		day_of_year -= (153 * month + 2) / 5;
+		month += 3;
 	}
 
-	dt->date.year  = tmp_year;
-	dt->date.month = tmp_month;
-	dt->date.day   = tmp_day;
-	dt->time.hour  = tmp_hour;
-	dt->time.min   = tmp_minutes;
-	dt->time.sec   = tmp;
+	dt->date.year  = year;
+	dt->date.month = month;
+	dt->date.day   = day_of_year + 1;
+	dt->time.hour  = secs / SECS_IN_HOUR;
+	dt->time.min   = secs % SECS_IN_HOUR / SECS_IN_MINUTE;
+	dt->time.sec   = secs % SECS_IN_MINUTE;
 
 	return ERR_NONE;
 }
@@ -201,8 +190,7 @@ static int32_t convert_timestamp_to_datetime(struct calendar_descriptor *const c
  */
 static uint32_t convert_datetime_to_timestamp(struct calendar_descriptor *const calendar, struct calendar_date_time *dt)
 {
-	uint32_t tmp = 0;
-	uint32_t i   = 0;
+	uint32_t days;
 	uint8_t  year, month, day, hour, minutes, seconds;
 
 	year    = dt->date.year - calendar->base_year;
@@ -212,27 +200,16 @@ static uint32_t convert_datetime_to_timestamp(struct calendar_descriptor *const
 	minutes = dt->time.min;
 	seconds = dt->time.sec;
 
-	/* tot up year field */
-	for (i = 0; i < year; ++i) {
-		if (leap_year(calendar->base_year + i)) {
-			tmp += SECS_IN_LEAP_YEAR;
-		} else {
-			tmp += SECS_IN_NON_LEAP_YEAR;
-		}
+	if (month > 13) {
+		month = 13;
 	}
 
-	/* tot up month field */
-	for (i = 1; i < month; ++i) {
-		tmp += get_secs_in_month(dt->date.year, i);
+	days = year * 365 + leap_years_between(calendar->base_year, year) + days_before_month[month];
+	if (month > 2 && leap_year(dt->date.year)) {
+		days++;
 	}
 
-	/* tot up day/hour/minute/second fields */
-	tmp += (day - 1) * SECS_IN_DAY;
-	tmp += hour * SECS_IN_HOUR;
-	tmp += minutes * SECS_IN_MINUTE;
-	tmp += seconds;
-
-	return tmp;
+	return days * SECS_IN_DAY + (day - 1) * SECS_IN_DAY + hour * SECS_IN_HOUR + minutes * SECS_IN_MINUTE + seconds;
 }
 
 /** \brief calibrate timestamp to make desired timestamp ahead of current timestamp
@@ -352,52 +329,129 @@ static void fill_alarm(struct calendar_descriptor *const calendar, struct calend
 	convert_timestamp_to_datetime(calendar, alarm->cal_alarm.timestamp, &alarm->cal_alarm.datetime);
 }
 
-/** \brief add new alarm into the list in ascending order
+/** \brief fields the compare register matches an alarm on
+ *
+ * Repeating alarms with a fixed period, every minute, hour or day, match on fewer fields so the
+ * hardware re-arms them. Days and months vary in length, so those alarms match in full and are
+ * set again each time they fire.
  */
-static int32_t calendar_add_new_alarm(struct list_descriptor *list, struct calendar_alarm *alarm)
+static enum calendar_alarm_option calendar_comp_option(struct calendar_alarm *alarm)
 {
-	struct calendar_descriptor *calendar = CONTAINER_OF(list, struct calendar_descriptor, alarms);
-	struct calendar_alarm *     head, *it, *prev = NULL;
+	if (alarm->cal_alarm.mode == REPEAT && alarm->cal_alarm.option >= CALENDAR_ALARM_MATCH_SEC
+	    && alarm->cal_alarm.option <= CALENDAR_ALARM_MATCH_HOUR) {
+		return alarm->cal_alarm.option;
+	}
+	return CALENDAR_ALARM_MATCH_YEAR;
+}
 
-	/*get the head of alarms list*/
-	head = (struct calendar_alarm *)list_get_head(list);
+/** \brief put the earliest pending alarm into the compare register
+ */
+static void calendar_set_comp(struct calendar_descriptor *const calendar)
+{
+	_calendar_set_comp(&calendar->device,
+	                   calendar->alarms[0]->cal_alarm.timestamp,
+	                   calendar_comp_option(calendar->alarms[0]));
+}
 
-	/*if head is null, insert new alarm as head*/
-	if (!head) {
-		list_insert_as_head(list, alarm);
-		_calendar_set_comp(&calendar->device, alarm->cal_alarm.timestamp);
-		return ERR_NONE;
-	}
+/** \brief swap two pending alarms and keep their heap indices in step
+ */
+static void calendar_heap_swap(struct calendar_descriptor *const calendar, uint8_t a, uint8_t b)
+{
+	struct calendar_alarm *tmp = calendar->alarms[a];
+
+	calendar->alarms[a]             = calendar->alarms[b];
+	calendar->alarms[b]             = tmp;
+	calendar->alarms[a]->heap_index = a;
+	calendar->alarms[b]->heap_index = b;
+}
 
-	/*insert the new alarm in accending order, the head will be invoked firstly */
-	for (it = head; it; it = (struct calendar_alarm *)list_get_next_element(it)) {
-		if (alarm->cal_alarm.timestamp <= it->cal_alarm.timestamp) {
+/** \brief move a pending alarm towards the root until its parent is due no later
+ */
+static void calendar_heap_sift_up(struct calendar_descriptor *const calendar, uint8_t i)
+{
+	while (i > 0) {
+		uint8_t parent = (i - 1) / 2;
+
+		if (calendar->alarms[parent]->cal_alarm.timestamp <= calendar->alarms[i]->cal_alarm.timestamp) {
 			break;
 		}
+		calendar_heap_swap(calendar, i, parent);
+		i = parent;
+	}
+}
+
+/** \brief move a pending alarm away from the root until its children are due no earlier
+ */
+static void calendar_heap_sift_down(struct calendar_descriptor *const calendar, uint8_t i)
+{
+	while (true) {
+		uint8_t  first = i;
+		uint16_t left  = 2 * i + 1;
+		uint16_t right = 2 * i + 2;
 
-		prev = it;
+		if (left < calendar->num_alarms
+		    && calendar->alarms[left]->cal_alarm.timestamp < calendar->alarms[first]->cal_alarm.timestamp) {
+			first = left;
+		}
+		if (right < calendar->num_alarms
+		    && calendar->alarms[right]->cal_alarm.timestamp < calendar->alarms[first]->cal_alarm.timestamp) {
+			first = right;
+		}
+		if (first == i) {
+			break;
+		}
+		calendar_heap_swap(calendar, i, first);
+		i = first;
 	}
+}
 
-	/*insert new alarm into the list */
-	if (it == head) {
-		list_insert_as_head(list, alarm);
-		/*get the head and set it into register*/
-		_calendar_set_comp(&calendar->device, alarm->cal_alarm.timestamp);
+/** \brief check whether an alarm is pending
+ */
+static bool calendar_is_pending(struct calendar_descriptor *const calendar, struct calendar_alarm *alarm)
+{
+	return alarm->heap_index < calendar->num_alarms && calendar->alarms[alarm->heap_index] == alarm;
+}
 
-	} else {
-		list_insert_after(prev, alarm);
+/** \brief add new alarm to the pending alarms
+ */
+static int32_t calendar_add_new_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *alarm)
+{
+	if (calendar->num_alarms >= CALENDAR_MAX_ALARMS) {
+		return ERR_NO_RESOURCE;
 	}
 
+	alarm->heap_index                      = calendar->num_alarms;
+	calendar->alarms[calendar->num_alarms] = alarm;
+	calendar->num_alarms++;
+	calendar_heap_sift_up(calendar, alarm->heap_index);
+
 	return ERR_NONE;
 }
 
+/** \brief remove a pending alarm
+ */
+static void calendar_remove_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *alarm)
+{
+	uint8_t i    = alarm->heap_index;
+	uint8_t last = calendar->num_alarms - 1;
+
+	if (i != last) {
+		calendar_heap_swap(calendar, i, last);
+	}
+	calendar->num_alarms--;
+	if (i != last) {
+		calendar_heap_sift_down(calendar, i);
+		calendar_heap_sift_up(calendar, calendar->alarms[i]->heap_index);
+	}
+}
+
 /** \brief callback for alarm
  */
 static void calendar_alarm(struct calendar_dev *const dev)
 {
 	struct calendar_descriptor *calendar = CONTAINER_OF(dev, struct calendar_descriptor, device);
 
-	struct calendar_alarm *head, *it, current_dt;
+	struct calendar_alarm *it, *armed, current_dt;
 
 	if ((calendar->flags & SET_ALARM_BUSY) || (calendar->flags & PROCESS_ALARM_BUSY)) {
 		calendar->flags |= PROCESS_ALARM_BUSY;
@@ -406,36 +460,41 @@ static void calendar_alarm(struct calendar_dev *const dev)
 
 	/* get current timestamp */
 	current_dt.cal_alarm.timestamp = _calendar_get_counter(dev);
+	convert_timestamp_to_datetime(calendar, current_dt.cal_alarm.timestamp, &current_dt.cal_alarm.datetime);
 
-	/* get the head */
-	head = (struct calendar_alarm *)list_get_head(&calendar->alarms);
-	ASSERT(head);
-
-	/* remove all alarms and invoke them*/
-	for (it = head; it; it = (struct calendar_alarm *)list_get_head(&calendar->alarms)) {
-		/* check the timestamp with current timestamp*/
-		if (it->cal_alarm.timestamp <= current_dt.cal_alarm.timestamp) {
-			list_remove_head(&calendar->alarms);
-			it->callback(calendar);
-
-			if (it->cal_alarm.mode == REPEAT) {
-				calibrate_timestamp(calendar, it, &current_dt);
-				convert_timestamp_to_datetime(calendar, it->cal_alarm.timestamp, &it->cal_alarm.datetime);
-				calendar_add_new_alarm(&calendar->alarms, it);
-			}
-		} else {
+	ASSERT(calendar->num_alarms);
+	armed = calendar->alarms[0];
+
+	/* invoke every alarm that is due; repeating ones go back into the heap at their next time */
+	while (calendar->num_alarms) {
+		it = calendar->alarms[0];
+		if (it->cal_alarm.timestamp > current_dt.cal_alarm.timestamp) {
 			break;
 		}
+
+		if (it->cal_alarm.mode == REPEAT) {
+			calibrate_timestamp(calendar, it, &current_dt);
+			convert_timestamp_to_datetime(calendar, it->cal_alarm.timestamp, &it->cal_alarm.datetime);
+			calendar_heap_sift_down(calendar, 0);
+		} else {
+			calendar_remove_alarm(calendar, it);
+		}
+		it->callback(calendar);
 	}
 
-	/*if no alarm in the list, register null */
-	if (!it) {
+	/*if no alarm is pending, register null */
+	if (!calendar->num_alarms) {
 		_calendar_register_callback(&calendar->device, NULL);
 		return;
 	}
 
-	/*put the new head into register */
-	_calendar_set_comp(&calendar->device, it->cal_alarm.timestamp);
+	/* a repeating alarm that is still the earliest re-armed itself in the compare register */
+	if (calendar->alarms[0] == armed && calendar_comp_option(armed) != CALENDAR_ALARM_MATCH_YEAR) {
+		return;
+	}
+
+	/*put the new earliest alarm into register */
+	calendar_set_comp(calendar);
 }
 
 /** \brief Initialize Calendar
@@ -532,9 +591,7 @@ int32_t calendar_set_time(struct calendar_descriptor *const calendar, struct cal
 
 	new_ts = convert_datetime_to_timestamp(calendar, &dt);
 
-	_calendar_set_counter(&calendar->device, new_ts);
-
-	return ERR_NONE;
+	return _calendar_set_counter(&calendar->device, new_ts);
 }
 
 /** \brief Set date for calendar
@@ -556,9 +613,7 @@ int32_t calendar_set_date(struct calendar_descriptor *const calendar, struct cal
 
 	new_ts = convert_datetime_to_timestamp(calendar, &dt);
 
-	_calendar_set_counter(&calendar->device, new_ts);
-
-	return ERR_NONE;
+	return _calendar_set_counter(&calendar->device, new_ts);
 }
 
 /** \brief Get date/time for calendar
@@ -577,61 +632,81 @@ int32_t calendar_get_date_time(struct calendar_descriptor *const calendar, struc
 	return ERR_NONE;
 }
 
-/** \brief Set alarm for calendar
+/** \brief add, move or remove an alarm whose timestamp is already filled in
  */
-int32_t calendar_set_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
-                           calendar_cb_alarm_t callback)
+static int32_t calendar_schedule_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
+                                       calendar_cb_alarm_t callback)
 {
-	struct calendar_alarm *head;
-
-	/* Sanity check arguments */
-	ASSERT(calendar);
-	ASSERT(alarm);
+	struct calendar_alarm *earliest;
+	int32_t                ret = ERR_NONE;
 
 	alarm->callback = callback;
 
-	fill_alarm(calendar, alarm);
-
 	calendar->flags |= SET_ALARM_BUSY;
 
-	head = (struct calendar_alarm *)list_get_head(&calendar->alarms);
+	earliest = calendar->num_alarms ? calendar->alarms[0] : NULL;
 
-	if (head != NULL) {
-		/* already added */
-		if (is_list_element(&calendar->alarms, alarm)) {
-			if (callback == NULL) {
-				/* remove alarm */
-				list_delete_element(&calendar->alarms, alarm);
+	/* remove it if already added, then re-add it unless the callback is NULL */
+	if (calendar_is_pending(calendar, alarm)) {
+		calendar_remove_alarm(calendar, alarm);
+	}
+	if (callback != NULL) {
+		ret = calendar_add_new_alarm(calendar, alarm);
+	}
 
-				if (!list_get_head(&calendar->alarms)) {
-					_calendar_register_callback(&calendar->device, NULL);
-				}
-			} else {
-				/* re-add */
-				list_delete_element(&calendar->alarms, alarm);
-				calendar_add_new_alarm(&calendar->alarms, alarm);
-			}
-		} else if (callback != NULL) {
-			calendar_add_new_alarm(&calendar->alarms, alarm);
+	/* the compare register only needs to change when the earliest alarm did, or was this one */
+	if (!calendar->num_alarms) {
+		if (earliest) {
+			_calendar_register_callback(&calendar->device, NULL);
 		}
-
-		calendar->flags &= ~SET_ALARM_BUSY;
-
-		if (calendar->flags & PROCESS_ALARM_BUSY) {
-			CRITICAL_SECTION_ENTER()
-			calendar->flags &= ~PROCESS_ALARM_BUSY;
-			_calendar_set_irq(&calendar->device);
-			CRITICAL_SECTION_LEAVE()
+	} else if (calendar->alarms[0] != earliest || earliest == alarm) {
+		calendar_set_comp(calendar);
+		if (!earliest) {
+			_calendar_register_callback(&calendar->device, calendar_alarm);
 		}
-	} else if (callback != NULL) {
-		/* if head is NULL, Register callback*/
-		_calendar_register_callback(&calendar->device, calendar_alarm);
-		calendar_add_new_alarm(&calendar->alarms, alarm);
 	}
 
 	calendar->flags &= ~SET_ALARM_BUSY;
 
-	return ERR_NONE;
+	if (calendar->flags & PROCESS_ALARM_BUSY) {
+		CRITICAL_SECTION_ENTER()
+		calendar->flags &= ~PROCESS_ALARM_BUSY;
+		_calendar_set_irq(&calendar->device);
+		CRITICAL_SECTION_LEAVE()
+	}
+
+	return ret;
+}
+
+/** \brief Set alarm for calendar
+ */
+int32_t calendar_set_alarm(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
+                           calendar_cb_alarm_t callback)
+{
+	/* Sanity check arguments */
+	ASSERT(calendar);
+	ASSERT(alarm);
+
+	fill_alarm(calendar, alarm);
+
+	return calendar_schedule_alarm(calendar, alarm, callback);
+}
+
+/** \brief Set one-shot alarm for calendar at a counter value
+ */
+int32_t calendar_set_alarm_at(struct calendar_descriptor *const calendar, struct calendar_alarm *const alarm,
+                              const uint32_t timestamp, calendar_cb_alarm_t callback)
+{
+	/* Sanity check arguments */
+	ASSERT(calendar);
+	ASSERT(alarm);
+
+	alarm->cal_alarm.timestamp = timestamp;
+	alarm->cal_alarm.option    = CALENDAR_ALARM_MATCH_YEAR;
+	alarm->cal_alarm.mode      = ONESHOT;
+	convert_timestamp_to_datetime(calendar, timestamp, &alarm->cal_alarm.datetime);
+
+	return calendar_schedule_alarm(calendar, alarm, callback);
 }
 
 /** \brief Retrieve driver version
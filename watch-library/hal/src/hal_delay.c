@@ -36,12 +36,21 @@
 #include <hpl_sleep.h>
 #include "hal_delay.h"
 #include <hpl_delay.h>
+#include <utils.h>
 
 /**
  * \brief Driver version
  */
 #define DRIVER_VERSION 0x00000001u
 
+/**
+ * \brief Delays of at least this many us are offered to _delay_sleep_us; shorter ones
+ * always spin, so their timing stays cycle-exact.
+ */
+#ifndef DELAY_SLEEP_THRESHOLD_US
+#define DELAY_SLEEP_THRESHOLD_US 2000
+#endif
+
 /**
  * \brief The pointer to a hardware instance used by the driver.
  */
@@ -60,6 +69,9 @@ void delay_init(void *const hw)
  */
 void delay_us(const uint16_t us)
 {
+	if (us >= DELAY_SLEEP_THRESHOLD_US && _delay_sleep_us(us)) {
+		return;
+	}
 	_delay_cycles(hardware, _get_cycles_for_us(us));
 }
 
@@ -68,9 +80,21 @@ void delay_us(const uint16_t us)
  */
 void delay_ms(const uint16_t ms)
 {
+	if ((uint32_t)ms * 1000 >= DELAY_SLEEP_THRESHOLD_US && _delay_sleep_us((uint32_t)ms * 1000)) {
+		return;
+	}
 	_delay_cycles(hardware, _get_cycles_for_ms(ms));
 }
 
+/**
+ * \brief Default for platforms that cannot sleep through a delay
+ */
+WEAK bool _delay_sleep_us(const uint32_t us)
+{
+	(void)us;
+	return false;
+}
+
 /**
  * \brief Retrieve the current driver version
  */
@@ -33,7 +33,8 @@
 
 #include "hal_ext_irq.h"
 
-#define EXT_IRQ_AMOUNT 3
+/* One slot per EXTINT line */
+#define EXT_IRQ_AMOUNT 16
 
 /**
  * \brief Driver version
@@ -41,25 +42,11 @@
 #define DRIVER_VERSION 0x00000001u
 
 /**
- * \brief External IRQ struct
+ * \brief Array of external IRQs callbacks, indexed by EXTINT line
  */
-struct ext_irq {
-	ext_irq_cb_t cb;
-	uint32_t     pin;
-};
+static ext_irq_cb_t ext_irqs[EXT_IRQ_AMOUNT];
 
-/* Remove KEIL compiling error in case no IRQ line selected */
-#if EXT_IRQ_AMOUNT == 0
-#undef EXT_IRQ_AMOUNT
-#define EXT_IRQ_AMOUNT 1
-#endif
-
-/**
- * \brief Array of external IRQs callbacks
- */
-static struct ext_irq ext_irqs[EXT_IRQ_AMOUNT];
-
-static void process_ext_irq(const uint32_t pin);
+static void process_ext_irq(const uint8_t extint);
 
 /**
  * \brief Initialize external irq component if any
@@ -69,8 +56,7 @@ int32_t ext_irq_init(void)
 	uint16_t i;
 
 	for (i = 0; i < EXT_IRQ_AMOUNT; i++) {
-		ext_irqs[i].pin = 0xFFFFFFFF;
-		ext_irqs[i].cb  = NULL;
+		ext_irqs[i] = NULL;
 	}
 
 	return _ext_irq_init(process_ext_irq);
@@ -89,48 +75,14 @@ int32_t ext_irq_deinit(void)
  */
 int32_t ext_irq_register(const uint32_t pin, ext_irq_cb_t cb)
 {
-	uint8_t i = 0, j = 0;
-	bool    found = false;
-
-	for (; i < EXT_IRQ_AMOUNT; i++) {
-		if (ext_irqs[i].pin == pin) {
-			ext_irqs[i].cb = cb;
-			found          = true;
-			break;
-		}
-	}
+	int32_t extint = _ext_irq_get_extint(pin);
 
-	if (NULL == cb) {
-		if (!found) {
-			return ERR_INVALID_ARG;
-		}
-		return _ext_irq_enable(pin, false);
-	}
-
-	if (!found) {
-		for (i = 0; i < EXT_IRQ_AMOUNT; i++) {
-			if (NULL == ext_irqs[i].cb) {
-				ext_irqs[i].cb  = cb;
-				ext_irqs[i].pin = pin;
-				found           = true;
-				break;
-			}
-		}
-		for (; (j < EXT_IRQ_AMOUNT) && (i < EXT_IRQ_AMOUNT); j++) {
-			if ((ext_irqs[i].pin < ext_irqs[j].pin) && (ext_irqs[j].pin != 0xFFFFFFFF)) {
-				struct ext_irq tmp = ext_irqs[j];
-
-				ext_irqs[j] = ext_irqs[i];
-				ext_irqs[i] = tmp;
-			}
-		}
-	}
-
-	if (!found) {
+	if (extint < 0 || extint >= EXT_IRQ_AMOUNT) {
 		return ERR_INVALID_ARG;
 	}
+	ext_irqs[extint] = cb;
 
-	return _ext_irq_enable(pin, true);
+	return _ext_irq_enable(pin, NULL != cb);
 }
 
 /**
@@ -160,29 +112,13 @@ uint32_t ext_irq_get_version(void)
 /**
  * \brief Interrupt processing routine
  *
- * \param[in] pin The pin which triggered the interrupt
+ * \param[in] extint The EXTINT line which triggered the interrupt
  */
-static void process_ext_irq(const uint32_t pin)
+static void process_ext_irq(const uint8_t extint)
 {
-	uint8_t lower = 0, middle, upper = EXT_IRQ_AMOUNT;
-
-	while (upper >= lower) {
-		middle = (upper + lower) >> 1;
-		if (middle >= EXT_IRQ_AMOUNT) {
-			return;
-		}
-
-		if (ext_irqs[middle].pin == pin) {
-			if (ext_irqs[middle].cb) {
-				ext_irqs[middle].cb();
-			}
-			return;
-		}
-
-		if (ext_irqs[middle].pin < pin) {
-			lower = middle + 1;
-		} else {
-			upper = middle - 1;
-		}
+	ext_irq_cb_t cb = ext_irqs[extint];
+
+	if (cb) {
+		cb();
 	}
 }
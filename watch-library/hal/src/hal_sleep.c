@@ -33,6 +33,7 @@
 
 #include "hal_sleep.h"
 #include <hpl_sleep.h>
+#include <utils.h>
 
 /**
  * \brief Driver version
@@ -58,10 +59,18 @@ int sleep(const uint8_t mode)
 		return ERR_INVALID_ARG;
 
 	_go_to_sleep();
+	_sleep_exit();
 
 	return ERR_NONE;
 }
 
+/**
+ * \brief Default for platforms with nothing to do on wake-up
+ */
+WEAK void _sleep_exit(void)
+{
+}
+
 /**
  * \brief Retrieve the current driver version
  *
@@ -0,0 +1,139 @@
+#include <stdbool.h>
+#include <string.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "host_adc.h"
+#include "host_dmac.h"
+#include "host_evsys.h"
+#include "host_registers.h"
+#include "host_sim.h"
+
+#define HOST_ADC_NUM_INPUTS 20
+// Sampling takes SAMPLEN + 1 ADC clocks, and the conversion one more per bit.
+#define HOST_ADC_CONVERSION_CLOCKS 13
+
+static uint16_t inputs[HOST_ADC_NUM_INPUTS];
+static host_adc_source_t source = NULL;
+
+static uint64_t pending_cycle = UINT64_MAX;
+// The cycle at which an event next starts a conversion, as of the last call to
+// host_adc_next_event().
+static uint64_t start_event_cycle = UINT64_MAX;
+static uint32_t conversions = 0;
+
+void host_adc_set_input(uint8_t ain, uint16_t code) {
+    if (ain < HOST_ADC_NUM_INPUTS) inputs[ain] = code & 0xFFF;
+}
+
+void host_adc_set_source(host_adc_source_t fn) {
+    source = fn;
+}
+
+uint32_t host_adc_get_conversions(void) {
+    return conversions;
+}
+
+bool host_adc_busy(void) {
+    return pending_cycle != UINT64_MAX;
+}
+
+static uint16_t sample(uint8_t ain) {
+    if (source) return source(ain) & 0xFFF;
+    return ain < HOST_ADC_NUM_INPUTS ? inputs[ain] : 0;
+}
+
+static uint8_t samplenum(void) {
+    uint8_t n = ADC->AVGCTRL.bit.SAMPLENUM;
+
+    return n > 10 ? 10 : n;
+}
+
+static void start_conversion(void) {
+    uint32_t clocks = (ADC->SAMPCTRL.bit.SAMPLEN + HOST_ADC_CONVERSION_CLOCKS) << samplenum();
+    uint32_t divider = 2u << ADC->CTRLB.bit.PRESCALER;
+
+    if (!ADC->CTRLA.bit.ENABLE || host_adc_busy()) return;
+    pending_cycle = host_sim_get_cycles()
+                  + (uint64_t)clocks * divider * CONF_CPU_FREQUENCY / CONF_GCLK_ADC_FREQUENCY;
+}
+
+/// Accumulates the samples as the ADC does: sums wider than 16 bits are shifted down to 16,
+/// then ADJRES divides what is left.
+static uint16_t convert(void) {
+    uint8_t ain = ADC->INPUTCTRL.bit.MUXPOS;
+    uint8_t n = samplenum();
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < (1ul << n); i++) sum += sample(ain);
+    if (n) {
+        if (n > 4) sum >>= n - 4;
+        return sum >> ADC->AVGCTRL.bit.ADJRES;
+    }
+    switch (ADC->CTRLC.bit.RESSEL) {
+        case ADC_CTRLC_RESSEL_10BIT_Val: return sum >> 2;
+        case ADC_CTRLC_RESSEL_8BIT_Val: return sum >> 4;
+        default: return sum;
+    }
+}
+
+static bool window_match(uint16_t result) {
+    uint16_t low = ADC->WINLT.reg, high = ADC->WINUT.reg;
+
+    switch (ADC->CTRLC.bit.WINMODE) {
+        case ADC_CTRLC_WINMODE_MODE1_Val: return result > low;
+        case ADC_CTRLC_WINMODE_MODE2_Val: return result < high;
+        case ADC_CTRLC_WINMODE_MODE3_Val: return result > low && result < high;
+        case ADC_CTRLC_WINMODE_MODE4_Val: return !(result > low && result < high);
+        default: return false;
+    }
+}
+
+static void complete_conversion(void) {
+    uint16_t result = convert();
+    uint8_t flags = ADC_INTFLAG_RESRDY | (window_match(result) ? ADC_INTFLAG_WINMON : 0);
+
+    pending_cycle = UINT64_MAX;
+    conversions++;
+    host_registers_unlock();
+    *(volatile uint16_t *)&ADC->RESULT.reg = result;
+    ADC->INTFLAG.reg |= flags;
+    // A DMAC channel waiting on RESRDY reads RESULT, which clears the flag.
+    if (host_dmac_trigger(HOST_DMAC_TRIGSRC_ADC_RESRDY)) ADC->INTFLAG.reg &= ~ADC_INTFLAG_RESRDY;
+    if (ADC->INTFLAG.reg & ADC->INTENSET.reg) NVIC->ISPR[0] |= 1ul << ADC_IRQn;
+    host_registers_lock();
+}
+
+uint64_t host_adc_next_event(void) {
+    start_event_cycle = UINT64_MAX;
+    if (ADC->CTRLA.bit.ENABLE && ADC->EVCTRL.bit.STARTEI) start_event_cycle = host_evsys_next_event(EVSYS_ID_USER_ADC_START);
+
+    return pending_cycle < start_event_cycle ? pending_cycle : start_event_cycle;
+}
+
+void host_adc_update(void) {
+    uint64_t now = host_sim_get_cycles();
+
+    if (pending_cycle == now) complete_conversion();
+    if (start_event_cycle == now) {
+        start_event_cycle = UINT64_MAX;
+        start_conversion();
+    }
+}
+
+void host_adc_ctrla_written(uint32_t before, uint32_t written) {
+    (void)before;
+    if (written & ADC_CTRLA_SWRST) {
+        memset((void *)ADC, 0, sizeof(Adc));
+        pending_cycle = UINT64_MAX;
+    } else if (!(written & ADC_CTRLA_ENABLE)) {
+        pending_cycle = UINT64_MAX;
+    }
+}
+
+void host_adc_swtrig_written(uint32_t before, uint32_t written) {
+    (void)before;
+    // SWTRIG reads back as zero. FLUSH abandons the conversion in progress.
+    ADC->SWTRIG.reg = 0;
+    if (written & ADC_SWTRIG_FLUSH) pending_cycle = UINT64_MAX;
+    if (written & ADC_SWTRIG_START) start_conversion();
+}
@@ -0,0 +1,50 @@
+/*
+ * ADC for the host build.
+ *
+ * A conversion starts on SWTRIG.START or, with EVCTRL.STARTEI set, on the event that the event
+ * system routes to the ADC's START user (see host_evsys.h). Each sample takes SAMPCTRL.SAMPLEN
+ * + 13 ADC clocks at the CTRLB prescaler, and AVGCTRL.SAMPLENUM asks for up to 1024 of them; then
+ * the accumulated, shifted and ADJRES-scaled result lands in RESULT and RESRDY comes up, along
+ * with WINMON if the result passes the CTRLC.WINMODE comparison. A DMAC channel triggered by
+ * RESRDY then takes the result, which clears the flag. OVERRUN is not modeled, since reads of
+ * RESULT cannot be trapped; firmware that reads RESULT clears RESRDY itself.
+ *
+ * The inputs are 12-bit codes set per AIN line, 0 until set. A source function, if given, is
+ * asked instead for every sample, so a harness can make signals that change over time or carry
+ * noise for the averaging to remove.
+ */
+#ifndef _HOST_ADC_H_
+#define _HOST_ADC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// Returns the 12-bit code an AIN line reads at this moment (see host_sim_get_cycles()).
+typedef uint16_t (*host_adc_source_t)(uint8_t ain);
+
+/** @brief Sets the code an analog input reads.
+  * @param ain The AIN line; A0, A1 and A2 are AIN12, AIN9 and AIN10.
+  * @param code A 12-bit code, 0 to 4095.
+  */
+void host_adc_set_input(uint8_t ain, uint16_t code);
+
+/** @brief Samples every input through a function instead, or through the fixed codes again if NULL. */
+void host_adc_set_source(host_adc_source_t source);
+
+/** @brief Returns the number of conversions completed, each counting all the samples it averaged. */
+uint32_t host_adc_get_conversions(void);
+
+/** @brief Returns whether a conversion is in progress. */
+bool host_adc_busy(void);
+
+/** @brief Returns the cycle at which a conversion completes or an event starts one, or UINT64_MAX. */
+uint64_t host_adc_next_event(void);
+
+/** @brief Completes the conversion due now and starts the one an event starts now, if any. */
+void host_adc_update(void);
+
+// Register write hooks for host_registers.c.
+void host_adc_ctrla_written(uint32_t before, uint32_t written);
+void host_adc_swtrig_written(uint32_t before, uint32_t written);
+
+#endif /* _HOST_ADC_H_ */
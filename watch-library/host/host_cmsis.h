@@ -0,0 +1,56 @@
+/*
+ * Host replacements for the CMSIS core_cmInstr.h and core_cmFunc.h intrinsics.
+ *
+ * Defining the CMSIS include guards here keeps the ARM inline assembly out of the host
+ * build. PRIMASK is a flag the simulator checks before it runs a handler: while it is set,
+ * interrupts stay pending, __WFI still returns once one is, and unmasking takes them. IPSR
+ * holds the exception number while a handler runs. __WFI hands control to the simulator so
+ * that it can advance time and deliver interrupts.
+ */
+#ifndef _HOST_CMSIS_H_
+#define _HOST_CMSIS_H_
+
+#define __CORE_CMINSTR_H
+#define __CORE_CMFUNC_H
+
+#include <stdint.h>
+
+extern volatile uint32_t host_primask;
+extern volatile uint32_t host_ipsr;
+void host_sim_wait_for_interrupt(void);
+void host_sim_deliver_pending(void);
+
+static inline void __enable_irq(void) {
+    host_primask = 0;
+    host_sim_deliver_pending();
+}
+static inline void __disable_irq(void) { host_primask = 1; }
+static inline uint32_t __get_PRIMASK(void) { return host_primask; }
+static inline void __set_PRIMASK(uint32_t priMask) {
+    host_primask = priMask & 1;
+    if (!host_primask) host_sim_deliver_pending();
+}
+
+static inline uint32_t __get_IPSR(void) { return host_ipsr; }
+
+static inline void __NOP(void) { }
+static inline void __SEV(void) { }
+static inline void __WFE(void) { host_sim_wait_for_interrupt(); }
+static inline void __WFI(void) { host_sim_wait_for_interrupt(); }
+static inline void __ISB(void) { __sync_synchronize(); }
+static inline void __DSB(void) { __sync_synchronize(); }
+static inline void __DMB(void) { __sync_synchronize(); }
+
+static inline uint32_t __REV(uint32_t value) { return __builtin_bswap32(value); }
+static inline uint32_t __REV16(uint32_t value) {
+    return ((value & 0xFF00FF00) >> 8) | ((value & 0x00FF00FF) << 8);
+}
+static inline int32_t __REVSH(int32_t value) { return (int16_t)__builtin_bswap16((uint16_t)value); }
+static inline uint32_t __ROR(uint32_t op1, uint32_t op2) {
+    op2 %= 32;
+    return op2 ? (op1 >> op2) | (op1 << (32 - op2)) : op1;
+}
+
+#define __BKPT(value) __builtin_trap()
+
+#endif /* _HOST_CMSIS_H_ */
@@ -0,0 +1,214 @@
+#include <stdbool.h>
+#include <string.h>
+#include "saml22.h"
+#include "host_dmac.h"
+#include "host_registers.h"
+#include "host_uart.h"
+
+typedef struct {
+    uint8_t ctrla;
+    uint32_t ctrlb;
+    uint8_t intenset;
+    uint8_t intflag;
+} host_dmac_bank_t;
+
+// The registers of every channel but the one CHID selects, which live in DMAC itself.
+static host_dmac_bank_t banks[DMAC_CH_NUM];
+
+static uint8_t selected_channel(void) {
+    return DMAC->CHID.reg & DMAC_CHID_ID_Msk;
+}
+
+static volatile uint8_t *chctrla(uint8_t channel) {
+    return channel == selected_channel() ? &DMAC->CHCTRLA.reg : &banks[channel].ctrla;
+}
+
+static volatile uint32_t *chctrlb(uint8_t channel) {
+    return channel == selected_channel() ? &DMAC->CHCTRLB.reg : &banks[channel].ctrlb;
+}
+
+static volatile uint8_t *chintenset(uint8_t channel) {
+    return channel == selected_channel() ? &DMAC->CHINTENSET.reg : &banks[channel].intenset;
+}
+
+static volatile uint8_t *chintflag(uint8_t channel) {
+    return channel == selected_channel() ? &DMAC->CHINTFLAG.reg : &banks[channel].intflag;
+}
+
+static DmacDescriptor *descriptor(uint32_t section, uint8_t channel) {
+    return (DmacDescriptor *)(uintptr_t)section + channel;
+}
+
+/// Points INTPEND at the lowest channel with an enabled interrupt, and pends the DMAC's IRQ.
+static void update_interrupt(void) {
+    uint32_t intstatus = 0;
+    uint16_t intpend = 0;
+
+    for (uint8_t channel = DMAC_CH_NUM; channel-- > 0;) {
+        uint8_t flags = *chintflag(channel);
+        if (!(flags & *chintenset(channel))) continue;
+        intstatus |= 1ul << channel;
+        intpend = DMAC_INTPEND_ID(channel) | (flags & DMAC_CHINTFLAG_MASK) << DMAC_INTPEND_TERR_Pos;
+    }
+    DMAC->INTPEND.reg = intpend;
+    *(volatile uint32_t *)&DMAC->INTSTATUS.reg = intstatus;
+    if (intstatus) NVIC->ISPR[0] |= 1ul << DMAC_IRQn;
+}
+
+static bool channel_enabled(uint8_t channel) {
+    uint8_t level = (*chctrlb(channel) & DMAC_CHCTRLB_LVL_Msk) >> DMAC_CHCTRLB_LVL_Pos;
+
+    return (*chctrla(channel) & DMAC_CHCTRLA_ENABLE) && (DMAC->CTRL.reg & DMAC_CTRL_DMAENABLE)
+        && (DMAC->CTRL.reg & (DMAC_CTRL_LVLEN0 << level));
+}
+
+static void fail(uint8_t channel) {
+    *chintflag(channel) |= DMAC_CHINTFLAG_TERR;
+    *chctrla(channel) &= ~DMAC_CHCTRLA_ENABLE;
+    update_interrupt();
+}
+
+static void load_descriptor(uint8_t channel, const DmacDescriptor *next) {
+    DmacDescriptor *current = descriptor(DMAC->WRBADDR.reg, channel);
+
+    memmove((void *)current, (const void *)next, sizeof(DmacDescriptor));
+    if (!current->BTCTRL.bit.VALID || !current->BTCNT.reg) fail(channel);
+}
+
+static void end_block(uint8_t channel) {
+    DmacDescriptor *current = descriptor(DMAC->WRBADDR.reg, channel);
+    uint8_t action = current->BTCTRL.bit.BLOCKACT;
+
+    // Suspending is not modeled; a suspending block action only raises its interrupt.
+    if (action == DMAC_BTCTRL_BLOCKACT_INT_Val || action == DMAC_BTCTRL_BLOCKACT_BOTH_Val) {
+        *chintflag(channel) |= DMAC_CHINTFLAG_TCMPL;
+    }
+    if (current->DESCADDR.reg) load_descriptor(channel, descriptor(current->DESCADDR.reg, 0));
+    else *chctrla(channel) &= ~DMAC_CHCTRLA_ENABLE;
+    update_interrupt();
+}
+
+/// Moves one beat. @return true if it was the last of its block.
+static bool beat(uint8_t channel) {
+    DmacDescriptor *current = descriptor(DMAC->WRBADDR.reg, channel);
+    DMAC_BTCTRL_Type btctrl = current->BTCTRL;
+    uint16_t remaining = current->BTCNT.reg;
+    uint8_t size = 1 << btctrl.bit.BEATSIZE;
+    uint32_t step = size << btctrl.bit.STEPSIZE;
+    uintptr_t src = current->SRCADDR.reg;
+    uintptr_t dst = current->DSTADDR.reg;
+    uint32_t value = 0;
+
+    // With increments on, the descriptor holds the address just past the end of the block.
+    if (btctrl.bit.SRCINC) src -= remaining * (btctrl.bit.STEPSEL ? step : size);
+    if (btctrl.bit.DSTINC) dst -= remaining * (btctrl.bit.STEPSEL ? size : step);
+    memcpy(&value, (const void *)src, size);
+    host_registers_write(dst, size, value);
+
+    current->BTCNT.reg = --remaining;
+    if (remaining) return false;
+    end_block(channel);
+    return true;
+}
+
+/// Whether a peripheral holds up a request that stays up until served, rather than pulsing it.
+static bool request_held(uint8_t channel) {
+    switch ((*chctrlb(channel) & DMAC_CHCTRLB_TRIGSRC_Msk) >> DMAC_CHCTRLB_TRIGSRC_Pos) {
+        case HOST_DMAC_TRIGSRC_SERCOM3_TX: return host_uart_data_empty();
+        default: return false;
+    }
+}
+
+static void run_channel(uint8_t channel) {
+    uint8_t action = (*chctrlb(channel) & DMAC_CHCTRLB_TRIGACT_Msk) >> DMAC_CHCTRLB_TRIGACT_Pos;
+
+    switch (action) {
+        case DMAC_CHCTRLB_TRIGACT_BEAT_Val:
+            beat(channel);
+            break;
+        case DMAC_CHCTRLB_TRIGACT_BLOCK_Val:
+            while (channel_enabled(channel) && !beat(channel));
+            break;
+        case DMAC_CHCTRLB_TRIGACT_TRANSACTION_Val:
+            while (channel_enabled(channel)) beat(channel);
+            break;
+    }
+}
+
+bool host_dmac_waiting(uint8_t trigsrc) {
+    for (uint8_t channel = 0; channel < DMAC_CH_NUM; channel++) {
+        if (!channel_enabled(channel)) continue;
+        if (((*chctrlb(channel) & DMAC_CHCTRLB_TRIGSRC_Msk) >> DMAC_CHCTRLB_TRIGSRC_Pos) == trigsrc) return true;
+    }
+
+    return false;
+}
+
+bool host_dmac_trigger(uint8_t trigsrc) {
+    for (uint8_t channel = 0; channel < DMAC_CH_NUM; channel++) {
+        if (!channel_enabled(channel)) continue;
+        if (((*chctrlb(channel) & DMAC_CHCTRLB_TRIGSRC_Msk) >> DMAC_CHCTRLB_TRIGSRC_Pos) != trigsrc) continue;
+        host_registers_unlock();
+        run_channel(channel);
+        host_registers_lock();
+        return true;
+    }
+
+    return false;
+}
+
+void host_dmac_swtrigctrl_written(uint32_t before, uint32_t written) {
+    uint32_t waiting = before | written;
+
+    // A software trigger stays pending until its channel is enabled to take it.
+    for (uint8_t channel = 0; channel < DMAC_CH_NUM; channel++) {
+        if (!(waiting & (1ul << channel)) || !channel_enabled(channel)) continue;
+        waiting &= ~(1ul << channel);
+        run_channel(channel);
+    }
+    DMAC->SWTRIGCTRL.reg = waiting;
+}
+
+void host_dmac_chid_written(uint32_t before, uint32_t written) {
+    host_dmac_bank_t *old = &banks[before & DMAC_CHID_ID_Msk];
+    host_dmac_bank_t *new = &banks[written & DMAC_CHID_ID_Msk];
+
+    if (old == new) return;
+    *old = (host_dmac_bank_t){
+        .ctrla = DMAC->CHCTRLA.reg, .ctrlb = DMAC->CHCTRLB.reg,
+        .intenset = DMAC->CHINTENSET.reg, .intflag = DMAC->CHINTFLAG.reg };
+    DMAC->CHCTRLA.reg = new->ctrla;
+    DMAC->CHCTRLB.reg = new->ctrlb;
+    DMAC->CHINTENSET.reg = new->intenset;
+    DMAC->CHINTENCLR.reg = new->intenset;
+    DMAC->CHINTFLAG.reg = new->intflag;
+}
+
+void host_dmac_chctrla_written(uint32_t before, uint32_t written) {
+    uint8_t channel = selected_channel();
+
+    if (written & DMAC_CHCTRLA_SWRST) {
+        DMAC->CHCTRLA.reg = 0;
+        DMAC->CHCTRLB.reg = 0;
+        DMAC->CHINTENSET.reg = 0;
+        DMAC->CHINTENCLR.reg = 0;
+        DMAC->CHINTFLAG.reg = 0;
+        update_interrupt();
+    } else if (!(before & DMAC_CHCTRLA_ENABLE) && (written & DMAC_CHCTRLA_ENABLE)) {
+        load_descriptor(channel, descriptor(DMAC->BASEADDR.reg, channel));
+        if (DMAC->SWTRIGCTRL.reg & (1ul << channel)) host_dmac_swtrigctrl_written(DMAC->SWTRIGCTRL.reg, 0);
+        else if (channel_enabled(channel) && request_held(channel)) run_channel(channel);
+    }
+}
+
+void host_dmac_chinten_written(uint32_t before, uint32_t written) {
+    (void)before;
+    (void)written;
+    update_interrupt();
+}
+
+void host_dmac_chintflag_written(uint32_t before, uint32_t written) {
+    (void)before;
+    (void)written;
+    update_interrupt();
+}
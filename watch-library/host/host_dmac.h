@@ -0,0 +1,49 @@
+/*
+ * DMAC for the host build.
+ *
+ * Channels run from the descriptors in SRAM as on the chip: enabling a channel copies its first
+ * descriptor from BASEADDR to the write-back section, and every beat moves one BEATSIZE unit and
+ * counts down BTCNT there. At the end of a block the channel raises TCMPL if BLOCKACT asks for
+ * the interrupt, then follows DESCADDR or disables itself. CHCTRLA, CHCTRLB and the channel
+ * interrupt registers are banked behind CHID.
+ *
+ * Peripheral models trigger beats with host_dmac_trigger() when their DMA request comes up;
+ * SWTRIGCTRL triggers them from firmware. A channel enabled while a level request like SERCOM
+ * TX's empty DATA is already up takes a beat at once. Beats take no simulated time. Stores go through
+ * host_registers_write(), so a beat into SERCOM DATA or a TC's CC starts what a CPU store would.
+ *
+ * Descriptors hold 32-bit addresses. The host binary is linked without PIE so that the static
+ * buffers firmware hands to the DMAC have addresses that fit; buffers on the stack or the heap
+ * do not, and are not supported.
+ */
+#ifndef _HOST_DMAC_H_
+#define _HOST_DMAC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// DMAC trigger sources (CHCTRLB.TRIGSRC) that the host peripheral models raise.
+#define HOST_DMAC_TRIGSRC_SERCOM1_RX 0x04
+#define HOST_DMAC_TRIGSRC_SERCOM1_TX 0x05
+#define HOST_DMAC_TRIGSRC_SERCOM3_TX 0x09
+#define HOST_DMAC_TRIGSRC_TC0_OVF 0x13
+#define HOST_DMAC_TRIGSRC_TC_STRIDE 3           ///< TC0 OVF, MC0, MC1, then TC1's, and so on
+#define HOST_DMAC_TRIGSRC_ADC_RESRDY 0x1F
+
+/** @brief Returns whether an enabled channel takes the given trigger. */
+bool host_dmac_waiting(uint8_t trigsrc);
+
+/** @brief Raises a peripheral DMA request and runs what the channels waiting on it transfer.
+  * @param trigsrc The trigger source, as in CHCTRLB.TRIGSRC.
+  * @return true if an enabled channel took the trigger.
+  */
+bool host_dmac_trigger(uint8_t trigsrc);
+
+// Register write hooks for host_registers.c.
+void host_dmac_swtrigctrl_written(uint32_t before, uint32_t written);
+void host_dmac_chid_written(uint32_t before, uint32_t written);
+void host_dmac_chctrla_written(uint32_t before, uint32_t written);
+void host_dmac_chinten_written(uint32_t before, uint32_t written);
+void host_dmac_chintflag_written(uint32_t before, uint32_t written);
+
+#endif /* _HOST_DMAC_H_ */
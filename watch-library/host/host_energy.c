@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "atmel_start_pins.h"
+#include "watch_energy.h"
+#include "host_energy.h"
+#include "host_adc.h"
+#include "host_sim.h"
+#include "host_uart.h"
+
+#define HOST_ENERGY_VDD 3.0
+
+typedef struct {
+    const char *name;
+    double current_ua;
+    double (*duty)(void);   ///< fraction of the span the load draws current, 0 to 1
+} host_energy_load_t;
+
+static bool core_active = true;
+
+static double duty_on(void) {
+    return 1;
+}
+
+static double duty_enabled(bool enabled) {
+    return enabled ? 1 : 0;
+}
+
+// In IDLE the core is stopped but the main clock tree keeps running for the peripherals.
+static double duty_idle(void) {
+    return duty_enabled(!core_active && PM->SLEEPCFG.bit.SLEEPMODE <= PM_SLEEPCFG_SLEEPMODE_IDLE2_Val);
+}
+
+static double duty_slcd(void) {
+    return duty_enabled(SLCD->CTRLA.bit.ENABLE);
+}
+
+static double duty_tc0(void) {
+    return duty_enabled(TC0->COUNT16.CTRLA.bit.ENABLE);
+}
+
+// In 32-bit mode TC1 counts as TC0's upper half.
+static double duty_tc1(void) {
+    return duty_enabled(TC1->COUNT16.CTRLA.bit.ENABLE
+                        || (TC0->COUNT16.CTRLA.bit.ENABLE && TC0->COUNT16.CTRLA.bit.MODE == TC_CTRLA_MODE_COUNT32_Val));
+}
+
+static double duty_tc3(void) {
+    return duty_enabled(TC3->COUNT16.CTRLA.bit.ENABLE);
+}
+
+static double duty_sercom1(void) {
+    return duty_enabled(SERCOM1->I2CM.CTRLA.bit.ENABLE);
+}
+
+// With ONDEMAND set, the ADC only draws while it converts.
+static double duty_adc(void) {
+    return duty_enabled(ADC->CTRLA.bit.ENABLE && (!ADC->CTRLA.bit.ONDEMAND || host_adc_busy()));
+}
+
+// SERCOM3 only has the main clock it runs from while a frame goes out.
+static double duty_sercom3(void) {
+    return duty_enabled(host_uart_busy());
+}
+
+static double duty_led(uint8_t pin, uint8_t channel) {
+    if (TC3->COUNT16.CTRLA.bit.ENABLE) {
+        // In 8-bit normal PWM the output is high while COUNT is below CC, out of PER + 1 counts.
+        if (TC3->COUNT8.CTRLA.bit.MODE == TC_CTRLA_MODE_COUNT8_Val) {
+            return TC3->COUNT8.CC[channel].reg / (TC3->COUNT8.PER.reg + 1.0);
+        }
+        return TC3->COUNT16.CC[channel].reg / 65535.0;
+    }
+
+    uint32_t mask = 1ul << GPIO_PIN(pin);
+    PortGroup *group = &PORT->Group[GPIO_PORT(pin)];
+    return duty_enabled((group->DIR.reg & mask) && (group->OUT.reg & mask));
+}
+
+static double duty_led_red(void) {
+    return duty_led(RED, 0);
+}
+
+static double duty_led_green(void) {
+    return duty_led(GREEN, 1);
+}
+
+// The first load only draws while the core runs; the rest draw regardless.
+static const host_energy_load_t loads[] = {
+    { "cpu", 39.0 * CONF_CPU_FREQUENCY / 1000000, duty_on },
+    { "standby", 1.2, duty_on },
+    { "idle", 12.0 * CONF_CPU_FREQUENCY / 1000000, duty_idle },
+    { "slcd", 3.5, duty_slcd },
+    { "tc0", 2.0, duty_tc0 },
+    { "tc1", 2.0, duty_tc1 },
+    { "tc3", 25.0, duty_tc3 },
+    { "sercom1", 30.0, duty_sercom1 },
+    { "adc", 110.0, duty_adc },
+    { "sercom3", 30.0, duty_sercom3 },
+    { "led_red", 2000.0, duty_led_red },
+    { "led_green", 2000.0, duty_led_green },
+};
+
+#define NUM_LOADS (sizeof(loads) / sizeof(loads[0]))
+
+static const char *region_names[WATCH_ENERGY_NUM_REGIONS] = {
+    "app_loop", "app_prepare_for_sleep", "app_wake_from_sleep", "app_handle_event", "RTC_Handler", "EIC_Handler", "DMAC_Handler",
+    "SERCOM1_Handler", "ADC_Handler", "SERCOM3_Handler", "TC0_Handler", "TC1_Handler",
+};
+
+typedef struct {
+    uint64_t active_cycles;
+    uint64_t sleep_cycles;
+    double load_on_cycles[NUM_LOADS];
+    uint64_t region_cycles[WATCH_ENERGY_NUM_REGIONS];
+    uint64_t region_host_ns[WATCH_ENERGY_NUM_REGIONS];
+    uint32_t region_calls[WATCH_ENERGY_NUM_REGIONS];
+    double charge_uc;
+} host_energy_wake_t;
+
+static host_energy_wake_t current;
+static host_energy_wake_t totals;
+static uint64_t wake_index = 0;
+
+static uint64_t region_entry_cycles[WATCH_ENERGY_NUM_REGIONS];
+static uint64_t region_entry_ns[WATCH_ENERGY_NUM_REGIONS];
+
+static uint64_t host_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+void watch_energy_enter(watch_energy_region_t region) {
+    host_sim_sync();
+    region_entry_cycles[region] = host_sim_get_cycles();
+    region_entry_ns[region] = host_ns();
+}
+
+void watch_energy_exit(watch_energy_region_t region) {
+    host_sim_sync();
+    current.region_cycles[region] += host_sim_get_cycles() - region_entry_cycles[region];
+    current.region_host_ns[region] += host_ns() - region_entry_ns[region];
+    current.region_calls[region]++;
+}
+
+void host_energy_integrate(uint64_t cycles, bool cpu_active) {
+    double seconds = (double)cycles / CONF_CPU_FREQUENCY;
+
+    core_active = cpu_active;
+    if (cpu_active) current.active_cycles += cycles;
+    else current.sleep_cycles += cycles;
+
+    for (size_t i = cpu_active ? 0 : 1; i < NUM_LOADS; i++) {
+        double duty = loads[i].duty();
+        current.load_on_cycles[i] += duty * cycles;
+        current.charge_uc += loads[i].current_ua * duty * seconds;
+    }
+}
+
+static void accumulate(host_energy_wake_t *into, const host_energy_wake_t *from) {
+    into->active_cycles += from->active_cycles;
+    into->sleep_cycles += from->sleep_cycles;
+    into->charge_uc += from->charge_uc;
+    for (size_t i = 0; i < NUM_LOADS; i++) into->load_on_cycles[i] += from->load_on_cycles[i];
+    for (size_t i = 0; i < WATCH_ENERGY_NUM_REGIONS; i++) {
+        into->region_cycles[i] += from->region_cycles[i];
+        into->region_host_ns[i] += from->region_host_ns[i];
+        into->region_calls[i] += from->region_calls[i];
+    }
+}
+
+static void print_wake(const char *label, const host_energy_wake_t *w) {
+    fprintf(stderr, "%s: %.3f uJ, active %llu cycles, slept %.3f s", label, w->charge_uc * HOST_ENERGY_VDD,
+            (unsigned long long)w->active_cycles, (double)w->sleep_cycles / CONF_CPU_FREQUENCY);
+    for (size_t i = 0; i < WATCH_ENERGY_NUM_REGIONS; i++) {
+        if (!w->region_calls[i]) continue;
+        fprintf(stderr, ", %s %llu cycles/%llu ns", region_names[i], (unsigned long long)w->region_cycles[i],
+                (unsigned long long)w->region_host_ns[i]);
+    }
+    for (size_t i = 2; i < NUM_LOADS; i++) {
+        if (w->load_on_cycles[i] == 0) continue;
+        fprintf(stderr, ", %s on %.0f us", loads[i].name, w->load_on_cycles[i] * 1000000 / CONF_CPU_FREQUENCY);
+    }
+    fprintf(stderr, "\n");
+}
+
+void host_energy_sleep(void) {
+    static int verbose = -1;
+    char label[32];
+
+    if (verbose < 0) verbose = getenv("WATCH_HOST_ENERGY") != NULL;
+    if (verbose) {
+        snprintf(label, sizeof(label), "wake %llu", (unsigned long long)wake_index);
+        print_wake(label, &current);
+    }
+
+    accumulate(&totals, &current);
+    current = (host_energy_wake_t){ 0 };
+    wake_index++;
+}
+
+void host_energy_report_totals(void) {
+    accumulate(&totals, &current);
+    current = (host_energy_wake_t){ 0 };
+    print_wake("total", &totals);
+}
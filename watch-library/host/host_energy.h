@@ -0,0 +1,30 @@
+/*
+ * Energy accounting backend for the host build.
+ *
+ * The simulator reports every span of simulated time together with whether the core
+ * was running or asleep. Each span is charged at the sum of the nominal currents of the
+ * loads that were on: the core itself, the STANDBY floor, the clock tree if the core
+ * slept in IDLE, and whichever of the SLCD, TC3, SERCOM1, ADC and LED pins the firmware
+ * left enabled. The results are grouped per
+ * wake (from __WFI() returning to the next __WFI()) and, with WATCH_HOST_ENERGY=1 in the
+ * environment, printed one line per wake.
+ *
+ * The current figures are nominal values from the SAM L22 electrical characteristics at
+ * 3 V and PL2; calibrate them against a real board before trusting absolute numbers.
+ */
+#ifndef _HOST_ENERGY_H_
+#define _HOST_ENERGY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @brief Charges a span of simulated time to the current wake. */
+void host_energy_integrate(uint64_t cycles, bool cpu_active);
+
+/** @brief Closes the current wake before the core goes to sleep. */
+void host_energy_sleep(void);
+
+/** @brief Prints totals for the run. */
+void host_energy_report_totals(void);
+
+#endif /* _HOST_ENERGY_H_ */
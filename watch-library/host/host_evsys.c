@@ -0,0 +1,39 @@
+#include "saml22.h"
+#include "host_evsys.h"
+#include "host_sim.h"
+#include "host_tc.h"
+
+// Each TC has three generators: OVF, then MC0 and MC1.
+#define HOST_EVSYS_TC_GENERATORS 3
+
+static Tc *const tcs[TC_INST_NUM] = { TC0, TC1, TC2, TC3 };
+
+static uint64_t rtc_period_event(uint8_t per) {
+    // PERn is the CLK_RTC prescaler's 1/8 << n output; it fires as that bit rises.
+    uint64_t period = 8ull << per;
+
+    if (!RTC->MODE2.CTRLA.bit.ENABLE || !(RTC->MODE2.EVCTRL.reg & (RTC_MODE2_EVCTRL_PEREO0 << per))) return UINT64_MAX;
+    return host_sim_cycle_of_tick((host_sim_get_ticks() / period + 1) * period);
+}
+
+static uint64_t tc_overflow_event(uint8_t index) {
+    if (!tcs[index]->COUNT16.EVCTRL.bit.OVFEO) return UINT64_MAX;
+    return host_tc_next_overflow(index);
+}
+
+uint64_t host_evsys_next_event(uint8_t user) {
+    uint8_t channel = EVSYS->USER[user].bit.CHANNEL;
+    uint8_t generator;
+
+    if (!channel || channel > EVSYS_CHANNELS) return UINT64_MAX;
+    generator = EVSYS->CHANNEL[channel - 1].bit.EVGEN;
+    if (generator >= EVSYS_ID_GEN_RTC_PER_0 && generator <= EVSYS_ID_GEN_RTC_PER_7) {
+        return rtc_period_event(generator - EVSYS_ID_GEN_RTC_PER_0);
+    }
+    if (generator >= EVSYS_ID_GEN_TC0_OVF && generator <= EVSYS_ID_GEN_TC3_OVF
+        && (generator - EVSYS_ID_GEN_TC0_OVF) % HOST_EVSYS_TC_GENERATORS == 0) {
+        return tc_overflow_event((generator - EVSYS_ID_GEN_TC0_OVF) / HOST_EVSYS_TC_GENERATORS);
+    }
+
+    return UINT64_MAX;
+}
@@ -0,0 +1,21 @@
+/*
+ * Event system for the host build.
+ *
+ * Peripheral models that take events ask here when the next one reaches them: an event user
+ * follows EVSYS->USER to its channel and the channel's EVGEN to a generator. The generators
+ * modeled are the RTC's periodic PERn outputs, with their PEREOn bits set in the RTC's EVCTRL,
+ * and the TC overflows, with OVFEO set in the TC's. Paths, edge selection and channel interrupts
+ * are not modeled; every event reaches its user on the cycle it happens.
+ */
+#ifndef _HOST_EVSYS_H_
+#define _HOST_EVSYS_H_
+
+#include <stdint.h>
+
+/** @brief Returns the first cycle after the current one at which an event reaches a user.
+  * @param user The event user, as in EVSYS_ID_USER_*.
+  * @return The cycle, or UINT64_MAX if no modeled generator is routed to the user.
+  */
+uint64_t host_evsys_next_event(uint8_t user);
+
+#endif /* _HOST_EVSYS_H_ */
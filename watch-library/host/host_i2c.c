@@ -0,0 +1,268 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "host_dmac.h"
+#include "host_i2c.h"
+#include "host_registers.h"
+#include "host_sim.h"
+
+#define HOST_I2C_MAX_DEVICES 8
+
+#define HOST_I2C_BUSSTATE_IDLE 1
+#define HOST_I2C_BUSSTATE_OWNER 2
+
+#define HOST_I2C_CMD_REPEATED_START 1
+#define HOST_I2C_CMD_READ 2
+#define HOST_I2C_CMD_STOP 3
+
+#define HOST_I2C_BYTE_FLAGS (SERCOM_I2CM_INTFLAG_MB | SERCOM_I2CM_INTFLAG_SB)
+#define HOST_I2C_STATUS_ERRORS (SERCOM_I2CM_STATUS_BUSERR | SERCOM_I2CM_STATUS_ARBLOST | SERCOM_I2CM_STATUS_LOWTOUT \
+                                | SERCOM_I2CM_STATUS_MEXTTOUT | SERCOM_I2CM_STATUS_SEXTTOUT | SERCOM_I2CM_STATUS_LENERR)
+
+#define I2CM (SERCOM1->I2CM)
+
+typedef struct {
+    uint8_t addr;
+    uint8_t *registers;
+    uint16_t size;
+    uint16_t pointer;
+} host_i2c_device_t;
+
+static host_i2c_device_t devices[HOST_I2C_MAX_DEVICES];
+static size_t num_devices = 0;
+
+// The slave that answered the current address, or NULL if the bus is idle or nobody did.
+static host_i2c_device_t *selected = NULL;
+static bool reading = false;
+// The first byte of a write sets the slave's register pointer.
+static bool pointer_written = false;
+// Bytes left before the automatic NACK and stop of an ADDR.LENEN transfer.
+static uint8_t length_remaining = 0;
+
+static uint8_t pending_flags = 0;
+static uint64_t pending_cycle = UINT64_MAX;
+static uint64_t polled_cycles = 0;
+
+static host_i2c_stats_t stats;
+
+void host_i2c_add_device(uint8_t addr, uint8_t *registers, uint16_t size) {
+    if (num_devices == HOST_I2C_MAX_DEVICES || !size) {
+        fprintf(stderr, "host: cannot add I2C device 0x%02x\n", addr);
+        exit(1);
+    }
+    devices[num_devices++] = (host_i2c_device_t){ .addr = addr, .registers = registers, .size = size };
+}
+
+host_i2c_stats_t host_i2c_get_stats(void) {
+    return stats;
+}
+
+void host_i2c_reset_stats(void) {
+    stats = (host_i2c_stats_t){ 0 };
+}
+
+uint64_t host_i2c_next_event(void) {
+    return pending_cycle;
+}
+
+static void continue_length_transfer(uint8_t flags);
+
+void host_i2c_complete(void) {
+    uint8_t flags = pending_flags;
+
+    pending_flags = 0;
+    pending_cycle = UINT64_MAX;
+    host_registers_unlock();
+    I2CM.INTFLAG.reg |= flags;
+    if (I2CM.ADDR.reg & SERCOM_I2CM_ADDR_LENEN) continue_length_transfer(flags);
+    host_registers_lock();
+}
+
+uint64_t host_i2c_take_polled_cycles(void) {
+    uint64_t n = polled_cycles;
+
+    polled_cycles = 0;
+    return n;
+}
+
+static uint64_t byte_cycles(void) {
+    uint32_t high = (I2CM.BAUD.reg & SERCOM_I2CM_BAUD_BAUD_Msk) >> SERCOM_I2CM_BAUD_BAUD_Pos;
+    uint32_t low = (I2CM.BAUD.reg & SERCOM_I2CM_BAUD_BAUDLOW_Msk) >> SERCOM_I2CM_BAUD_BAUDLOW_Pos;
+
+    // An SCL period is 10 + BAUD + BAUDLOW core clocks (BAUDLOW 0 means the same as BAUD);
+    // a byte and its acknowledge take nine.
+    if (!low) low = high;
+    return 9ull * (10 + high + low) * CONF_CPU_FREQUENCY / CONF_GCLK_SERCOM1_CORE_FREQUENCY;
+}
+
+static bool length_enabled(void) {
+    return I2CM.ADDR.reg & SERCOM_I2CM_ADDR_LENEN;
+}
+
+static bool bus_owned(void) {
+    return I2CM.STATUS.bit.BUSSTATE == HOST_I2C_BUSSTATE_OWNER;
+}
+
+static void set_bus_state(uint8_t state) {
+    I2CM.STATUS.reg = (I2CM.STATUS.reg & ~SERCOM_I2CM_STATUS_BUSSTATE_Msk) | SERCOM_I2CM_STATUS_BUSSTATE(state);
+}
+
+/// Puts bytes on the bus. Their flags come up when they are done, or at once for a polled transfer.
+/// LENEN transfers are meant for the DMAC and always run in the background.
+static void begin_bytes(uint8_t flags, uint8_t count) {
+    I2CM.INTFLAG.reg &= ~HOST_I2C_BYTE_FLAGS;
+    if ((I2CM.INTENSET.reg & HOST_I2C_BYTE_FLAGS) || length_enabled()) {
+        // Polled transfers not yet charged to simulated time still came first.
+        pending_flags = flags;
+        pending_cycle = host_sim_get_cycles() + polled_cycles + count * byte_cycles();
+    } else {
+        I2CM.INTFLAG.reg |= flags;
+        polled_cycles += count * byte_cycles();
+    }
+}
+
+static void receive_byte(uint8_t count) {
+    stats.bytes++;
+    I2CM.DATA.reg = selected->registers[selected->pointer];
+    selected->pointer = (selected->pointer + 1) % selected->size;
+    begin_bytes(SERCOM_I2CM_INTFLAG_SB, count);
+}
+
+static void start(uint32_t addr) {
+    uint8_t address = (addr >> 1) & 0x7F;
+
+    stats.starts++;
+    if (!bus_owned()) stats.transactions++;
+    set_bus_state(HOST_I2C_BUSSTATE_OWNER);
+    I2CM.STATUS.reg &= ~SERCOM_I2CM_STATUS_RXNACK;
+    reading = addr & 1;
+    pointer_written = false;
+    length_remaining = (addr & SERCOM_I2CM_ADDR_LEN_Msk) >> SERCOM_I2CM_ADDR_LEN_Pos;
+    selected = NULL;
+    for (size_t i = 0; i < num_devices && !(addr & SERCOM_I2CM_ADDR_TENBITEN); i++) {
+        if (devices[i].addr == address) selected = &devices[i];
+    }
+
+    if (selected == NULL && (addr & SERCOM_I2CM_ADDR_LENEN) && !reading) {
+        // A write NACKed before LEN bytes is a length error, and the master stops by itself.
+        I2CM.STATUS.reg |= SERCOM_I2CM_STATUS_RXNACK | SERCOM_I2CM_STATUS_LENERR;
+        begin_bytes(SERCOM_I2CM_INTFLAG_ERROR, 1);
+    } else if (selected == NULL) {
+        I2CM.STATUS.reg |= SERCOM_I2CM_STATUS_RXNACK;
+        begin_bytes(SERCOM_I2CM_INTFLAG_MB, 1);
+    } else if (reading) {
+        // The address byte, then the first data byte.
+        receive_byte(2);
+    } else {
+        begin_bytes(SERCOM_I2CM_INTFLAG_MB, 1);
+    }
+}
+
+static void stop(void) {
+    I2CM.INTFLAG.reg &= ~HOST_I2C_BYTE_FLAGS;
+    set_bus_state(HOST_I2C_BUSSTATE_IDLE);
+    selected = NULL;
+    pending_flags = 0;
+    pending_cycle = UINT64_MAX;
+}
+
+/// Ends a LENEN transfer on the bus, leaving its last flags up.
+static void stop_automatically(void) {
+    set_bus_state(HOST_I2C_BUSSTATE_IDLE);
+    selected = NULL;
+}
+
+/// Hands each byte of a LENEN transfer to the DMAC as its flag comes up.
+static void continue_length_transfer(uint8_t flags) {
+    if (flags & SERCOM_I2CM_INTFLAG_ERROR) {
+        stop_automatically();
+    } else if (!bus_owned() || !selected) {
+        return;
+    } else if (reading && (flags & SERCOM_I2CM_INTFLAG_SB) && I2CM.CTRLB.bit.SMEN) {
+        // The DMAC's read of DATA acknowledges the byte, or NACKs the last one.
+        if (!host_dmac_trigger(HOST_DMAC_TRIGSRC_SERCOM1_RX)) return;
+        I2CM.INTFLAG.reg &= ~SERCOM_I2CM_INTFLAG_SB;
+        if (--length_remaining) receive_byte(1);
+        else stop_automatically();
+    } else if (!reading && (flags & SERCOM_I2CM_INTFLAG_MB)) {
+        // The DMAC's store to DATA sends the next byte (see host_i2c_data_written).
+        if (!length_remaining) stop_automatically();
+        else host_dmac_trigger(HOST_DMAC_TRIGSRC_SERCOM1_TX);
+    }
+}
+
+void host_i2c_ctrla_written(uint32_t before, uint32_t written) {
+    (void)before;
+    if (written & SERCOM_I2CM_CTRLA_SWRST) {
+        memset((void *)&I2CM, 0, sizeof(SercomI2cm));
+        stop();
+        set_bus_state(0);
+    } else if (written & SERCOM_I2CM_CTRLA_ENABLE) {
+        if (!I2CM.STATUS.bit.BUSSTATE) set_bus_state(HOST_I2C_BUSSTATE_IDLE);
+    } else {
+        stop();
+        set_bus_state(0);
+    }
+}
+
+void host_i2c_ctrlb_written(uint32_t before, uint32_t written) {
+    uint8_t cmd = (written & SERCOM_I2CM_CTRLB_CMD_Msk) >> SERCOM_I2CM_CTRLB_CMD_Pos;
+
+    (void)before;
+    // CMD executes and reads back as zero.
+    I2CM.CTRLB.reg &= ~SERCOM_I2CM_CTRLB_CMD_Msk;
+    if (!cmd || !bus_owned()) return;
+
+    switch (cmd) {
+        case HOST_I2C_CMD_REPEATED_START:
+            start(I2CM.ADDR.reg);
+            break;
+        case HOST_I2C_CMD_READ:
+            if (reading && selected) receive_byte(1);
+            break;
+        case HOST_I2C_CMD_STOP:
+            stop();
+            break;
+    }
+}
+
+void host_i2c_intflag_written(uint32_t before, uint32_t written) {
+    // In smart mode, reading DATA acknowledges a byte and fetches the next. Reads cannot be
+    // trapped, so clearing SB afterwards, which the driver does too, stands in for it.
+    if (!(before & written & SERCOM_I2CM_INTFLAG_SB) || !bus_owned() || !reading || !selected) return;
+    if (I2CM.CTRLB.bit.SMEN && !I2CM.CTRLB.bit.ACKACT) receive_byte(1);
+}
+
+void host_i2c_addr_written(uint32_t before, uint32_t written) {
+    (void)before;
+    if (I2CM.STATUS.bit.BUSSTATE == HOST_I2C_BUSSTATE_IDLE || bus_owned()) start(written);
+}
+
+void host_i2c_data_written(uint32_t before, uint32_t written) {
+    (void)before;
+    if (!bus_owned() || reading || !selected) return;
+
+    stats.bytes++;
+    if (!pointer_written) {
+        selected->pointer = (uint8_t)written % selected->size;
+        pointer_written = true;
+    } else {
+        selected->registers[selected->pointer] = written;
+        selected->pointer = (selected->pointer + 1) % selected->size;
+    }
+    if (length_enabled() && length_remaining) length_remaining--;
+    begin_bytes(SERCOM_I2CM_INTFLAG_MB, 1);
+}
+
+void host_i2c_status_written(uint32_t before, uint32_t written) {
+    uint16_t status = before & ~(written & HOST_I2C_STATUS_ERRORS);
+
+    // Error bits clear when written with 1. BUSSTATE can be forced, typically to IDLE.
+    if (written & SERCOM_I2CM_STATUS_BUSSTATE_Msk) {
+        status = (status & ~SERCOM_I2CM_STATUS_BUSSTATE_Msk) | (written & SERCOM_I2CM_STATUS_BUSSTATE_Msk);
+    }
+    I2CM.STATUS.reg = status;
+}
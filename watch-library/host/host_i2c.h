@@ -0,0 +1,60 @@
+/*
+ * SERCOM1 I2C master and a bus of simulated slaves for the host build.
+ *
+ * Writes to the master's ADDR, DATA, CTRLB.CMD and INTFLAG are trapped (see host_registers.h)
+ * and answered the way the peripheral would: MB after an address or byte goes out, SB with
+ * DATA loaded when a byte comes in, RXNACK when nobody answers an address. Smart mode is
+ * assumed, with clearing SB standing in for the DATA read that acknowledges a byte.
+ *
+ * Each byte takes nine SCL periods at the programmed BAUD. While the MB/SB interrupts are
+ * enabled the flags come up that much later in simulated time, and the core can sleep in
+ * between; polled transfers see them at once and the simulator charges the same time as
+ * busy-waiting before the core next sleeps.
+ *
+ * With ADDR.LENEN set the master counts ADDR.LEN bytes itself for the DMAC: each SB or MB raises
+ * the SERCOM1 RX or TX DMA request, the last byte of a read is NACKed, and the transfer ends with
+ * a stop. A slave that NACKs the address of such a write sets STATUS.LENERR and INTFLAG.ERROR.
+ *
+ * Slaves are register files with an auto-incrementing pointer, as most sensors are: the first
+ * byte of a write sets the pointer, and later bytes are written or read from it onward.
+ */
+#ifndef _HOST_I2C_H_
+#define _HOST_I2C_H_
+
+#include <stdint.h>
+
+typedef struct {
+    uint32_t transactions;  ///< starts from an idle bus
+    uint32_t starts;        ///< address bytes sent, repeated starts included
+    uint32_t bytes;         ///< data bytes moved either way, register pointers included
+} host_i2c_stats_t;
+
+/** @brief Puts a register-file slave on the simulated bus.
+  * @param addr The seven-bit slave address.
+  * @param registers The slave's registers; the firmware's writes land here.
+  * @param size The number of registers. The pointer wraps around at the end.
+  */
+void host_i2c_add_device(uint8_t addr, uint8_t *registers, uint16_t size);
+
+/** @brief Returns the bus traffic since the program started or the stats were last reset. */
+host_i2c_stats_t host_i2c_get_stats(void);
+void host_i2c_reset_stats(void);
+
+/** @brief Returns the cycle at which the byte on the bus completes, or UINT64_MAX if none is. */
+uint64_t host_i2c_next_event(void);
+
+/** @brief Completes the byte on the bus by raising its INTFLAG bits. */
+void host_i2c_complete(void);
+
+/** @brief Returns, and forgets, the bus time that polled transfers have spent since the last call. */
+uint64_t host_i2c_take_polled_cycles(void);
+
+// Register write hooks for host_registers.c.
+void host_i2c_ctrla_written(uint32_t before, uint32_t written);
+void host_i2c_ctrlb_written(uint32_t before, uint32_t written);
+void host_i2c_intflag_written(uint32_t before, uint32_t written);
+void host_i2c_addr_written(uint32_t before, uint32_t written);
+void host_i2c_data_written(uint32_t before, uint32_t written);
+void host_i2c_status_written(uint32_t before, uint32_t written);
+
+#endif /* _HOST_I2C_H_ */
@@ -0,0 +1,92 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "saml22.h"
+#include "host_peripherals.h"
+#include "host_registers.h"
+
+#ifndef MAP_FIXED_NOREPLACE
+#define MAP_FIXED_NOREPLACE 0x100000
+#endif
+
+typedef struct {
+    uintptr_t base;
+    size_t size;
+} host_region_t;
+
+static const host_region_t regions[] = {
+    { FLASH_USER_PAGE_ADDR, 0x8000 },   // user row, calibration row, OTP, temperature log
+    { HPB0_ADDR, 0x3000 },              // PAC .. FREQM
+    { HPB1_ADDR, 0xB000 },              // USB .. MTB
+    { HPB2_ADDR, 0x5000 },              // EVSYS .. CCL
+    { SCS_BASE, 0x1000 },               // SysTick, NVIC, SCB
+};
+
+static const size_t num_regions = sizeof(regions) / sizeof(regions[0]);
+
+static bool mapped = false;
+
+static void map_or_die(uintptr_t base, size_t size, int flags, int fd) {
+    void *p = mmap((void *)base, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    if (p != (void *)base) {
+        fprintf(stderr, "host: cannot map peripheral space at 0x%08lx\n", (unsigned long)base);
+        exit(1);
+    }
+}
+
+static void map_peripherals(void) {
+    for (size_t i = 0; i < num_regions; i++) {
+        map_or_die(regions[i].base, regions[i].size, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1);
+    }
+
+    // PORT is reachable both over APB and over the single-cycle IOBUS; back both views
+    // with the same page so that gpio writes through PORT_IOBUS are visible via PORT.
+    int fd = memfd_create("host-port", 0);
+    if (fd < 0 || ftruncate(fd, 0x1000)) {
+        fprintf(stderr, "host: cannot create PORT backing\n");
+        exit(1);
+    }
+    map_or_die((uintptr_t)PORT, 0x1000, MAP_SHARED | MAP_FIXED, fd);
+    map_or_die((uintptr_t)PORT_IOBUS, 0x1000, MAP_SHARED | MAP_FIXED_NOREPLACE, fd);
+    close(fd);
+}
+
+void host_peripherals_reset(void) {
+    if (!mapped) {
+        map_peripherals();
+        mapped = true;
+    } else {
+        host_registers_unlock();
+        for (size_t i = 0; i < num_regions; i++) memset((void *)regions[i].base, 0, regions[i].size);
+        memset((void *)PORT, 0, 0x1000);
+        host_registers_lock();
+    }
+
+    host_registers_unlock();
+
+    // Clocks, oscillators and regulators are ready as soon as they are asked for.
+    // STATUS registers are read-only to firmware, hence the casts.
+    *(volatile uint32_t *)&SUPC->STATUS.reg = SUPC_STATUS_VREGRDY | SUPC_STATUS_BOD33RDY | SUPC_STATUS_VCORERDY;
+    *(volatile uint32_t *)&OSCCTRL->STATUS.reg = OSCCTRL_STATUS_XOSCRDY | OSCCTRL_STATUS_OSC16MRDY
+                                               | OSCCTRL_STATUS_DFLLRDY;
+    *(volatile uint32_t *)&OSC32KCTRL->STATUS.reg = OSC32KCTRL_STATUS_XOSC32KRDY;
+    MCLK->INTFLAG.reg = MCLK_INTFLAG_CKRDY;
+
+    // The debug UART never backs up.
+    for (int i = 0; i < SERCOM_INST_NUM; i++) {
+        ((Sercom *)((uintptr_t)SERCOM0 + 0x400 * i))->USART.INTFLAG.reg = SERCOM_USART_INTFLAG_DRE
+                                                                         | SERCOM_USART_INTFLAG_TXC;
+    }
+
+    host_registers_lock();
+}
+
+__attribute__((constructor)) static void host_peripherals_init(void) {
+    host_peripherals_reset();
+    host_registers_init();
+}
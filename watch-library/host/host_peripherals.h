@@ -0,0 +1,21 @@
+/*
+ * RAM-backed stand-ins for the SAM L22 peripheral register blocks.
+ *
+ * The device header addresses peripherals as fixed pointers (RTC is (Rtc *)0x40002400UL,
+ * and so on) and some HPL code relies on that layout, e.g. _sercom_get_hardware_index
+ * assumes a 0x400 stride between SERCOM instances. Rather than redefine every macro, we
+ * map zeroed anonymous memory at the real bus addresses before main() runs: the NVM
+ * calibration rows, the three APB bridges, the single-cycle I/O port alias and the
+ * Cortex-M0+ system control space. The hri_*_l22.h accessors then run unmodified.
+ */
+#ifndef _HOST_PERIPHERALS_H_
+#define _HOST_PERIPHERALS_H_
+
+#include <stdbool.h>
+
+/** @brief Maps the peripheral address space and loads power-on register values.
+  * Runs automatically as a constructor; exposed so a harness can reset between runs.
+  */
+void host_peripherals_reset(void);
+
+#endif /* _HOST_PERIPHERALS_H_ */
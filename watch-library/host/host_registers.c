@@ -0,0 +1,305 @@
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <signal.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "saml22.h"
+#include "host_registers.h"
+#include "host_adc.h"
+#include "host_dmac.h"
+#include "host_i2c.h"
+#include "host_tc.h"
+#include "host_uart.h"
+
+#define HOST_PAGE_SIZE 0x1000
+#define HOST_TRAP_FLAG 0x100
+
+typedef struct {
+    uintptr_t base;
+    const host_register_t *registers;
+    size_t count;
+} host_register_block_t;
+
+#define REG(type, field, width, kind, target) \
+    { offsetof(type, field), width, kind, offsetof(type, target), NULL }
+#define HOOK(type, field, width, kind, target, hook) \
+    { offsetof(type, field), width, kind, offsetof(type, target), hook }
+
+static const host_register_t rtc_registers[] = {
+    REG(RtcMode0, INTENCLR, 2, HOST_REGISTER_CLR, INTENSET),
+    REG(RtcMode0, INTENSET, 2, HOST_REGISTER_SET, INTENSET),
+    REG(RtcMode0, INTFLAG, 2, HOST_REGISTER_W1C, INTFLAG),
+    REG(RtcMode0, TAMPID, 4, HOST_REGISTER_W1C, TAMPID),
+};
+
+static const host_register_t eic_registers[] = {
+    REG(Eic, INTENCLR, 4, HOST_REGISTER_CLR, INTENSET),
+    REG(Eic, INTENSET, 4, HOST_REGISTER_SET, INTENSET),
+    REG(Eic, INTFLAG, 4, HOST_REGISTER_W1C, INTFLAG),
+};
+
+static const host_register_t port_group_registers[] = {
+    REG(PortGroup, DIRCLR, 4, HOST_REGISTER_CLR, DIR),
+    REG(PortGroup, DIRSET, 4, HOST_REGISTER_SET, DIR),
+    REG(PortGroup, DIRTGL, 4, HOST_REGISTER_TGL, DIR),
+    REG(PortGroup, OUTCLR, 4, HOST_REGISTER_CLR, OUT),
+    REG(PortGroup, OUTSET, 4, HOST_REGISTER_SET, OUT),
+    REG(PortGroup, OUTTGL, 4, HOST_REGISTER_TGL, OUT),
+};
+
+static const host_register_t sercom_i2cm_registers[] = {
+    HOOK(SercomI2cm, CTRLA, 4, HOST_REGISTER_PLAIN, CTRLA, host_i2c_ctrla_written),
+    HOOK(SercomI2cm, CTRLB, 4, HOST_REGISTER_PLAIN, CTRLB, host_i2c_ctrlb_written),
+    REG(SercomI2cm, INTENCLR, 1, HOST_REGISTER_CLR, INTENSET),
+    REG(SercomI2cm, INTENSET, 1, HOST_REGISTER_SET, INTENSET),
+    HOOK(SercomI2cm, INTFLAG, 1, HOST_REGISTER_W1C, INTFLAG, host_i2c_intflag_written),
+    HOOK(SercomI2cm, STATUS, 2, HOST_REGISTER_PLAIN, STATUS, host_i2c_status_written),
+    HOOK(SercomI2cm, ADDR, 4, HOST_REGISTER_PLAIN, ADDR, host_i2c_addr_written),
+    HOOK(SercomI2cm, DATA, 1, HOST_REGISTER_PLAIN, DATA, host_i2c_data_written),
+};
+
+static const host_register_t sercom_usart_registers[] = {
+    HOOK(SercomUsart, CTRLA, 4, HOST_REGISTER_PLAIN, CTRLA, host_uart_ctrla_written),
+    HOOK(SercomUsart, INTENCLR, 1, HOST_REGISTER_CLR, INTENSET, host_uart_inten_written),
+    HOOK(SercomUsart, INTENSET, 1, HOST_REGISTER_SET, INTENSET, host_uart_inten_written),
+    REG(SercomUsart, INTFLAG, 1, HOST_REGISTER_W1C, INTFLAG),
+    HOOK(SercomUsart, DATA, 2, HOST_REGISTER_PLAIN, DATA, host_uart_data_written),
+};
+
+static const host_register_t dmac_registers[] = {
+    HOOK(Dmac, SWTRIGCTRL, 4, HOST_REGISTER_PLAIN, SWTRIGCTRL, host_dmac_swtrigctrl_written),
+    HOOK(Dmac, CHID, 1, HOST_REGISTER_PLAIN, CHID, host_dmac_chid_written),
+    HOOK(Dmac, CHCTRLA, 1, HOST_REGISTER_PLAIN, CHCTRLA, host_dmac_chctrla_written),
+    HOOK(Dmac, CHINTENCLR, 1, HOST_REGISTER_CLR, CHINTENSET, host_dmac_chinten_written),
+    HOOK(Dmac, CHINTENSET, 1, HOST_REGISTER_SET, CHINTENSET, host_dmac_chinten_written),
+    HOOK(Dmac, CHINTFLAG, 1, HOST_REGISTER_W1C, CHINTFLAG, host_dmac_chintflag_written),
+};
+
+static const host_register_t adc_registers[] = {
+    HOOK(Adc, CTRLA, 1, HOST_REGISTER_PLAIN, CTRLA, host_adc_ctrla_written),
+    REG(Adc, INTENCLR, 1, HOST_REGISTER_CLR, INTENSET),
+    REG(Adc, INTENSET, 1, HOST_REGISTER_SET, INTENSET),
+    REG(Adc, INTFLAG, 1, HOST_REGISTER_W1C, INTFLAG),
+    HOOK(Adc, SWTRIG, 1, HOST_REGISTER_PLAIN, SWTRIG, host_adc_swtrig_written),
+};
+
+// Only the hooks differ between instances, telling the model which TC it is.
+#define TC_REGISTERS(ctrla_hook, ctrlbset_hook) \
+    HOOK(TcCount16, CTRLA, 4, HOST_REGISTER_PLAIN, CTRLA, ctrla_hook), \
+    REG(TcCount16, CTRLBCLR, 1, HOST_REGISTER_CLR, CTRLBSET), \
+    HOOK(TcCount16, CTRLBSET, 1, HOST_REGISTER_SET, CTRLBSET, ctrlbset_hook), \
+    REG(TcCount16, INTENCLR, 1, HOST_REGISTER_CLR, INTENSET), \
+    REG(TcCount16, INTENSET, 1, HOST_REGISTER_SET, INTENSET), \
+    REG(TcCount16, INTFLAG, 1, HOST_REGISTER_W1C, INTFLAG)
+
+static const host_register_t tc0_registers[] = { TC_REGISTERS(host_tc0_ctrla_written, host_tc0_ctrlbset_written) };
+static const host_register_t tc1_registers[] = { TC_REGISTERS(host_tc1_ctrla_written, host_tc1_ctrlbset_written) };
+static const host_register_t tc2_registers[] = { TC_REGISTERS(host_tc2_ctrla_written, host_tc2_ctrlbset_written) };
+static const host_register_t tc3_registers[] = { TC_REGISTERS(host_tc3_ctrla_written, host_tc3_ctrlbset_written) };
+
+static const host_register_t nvic_registers[] = {
+    REG(NVIC_Type, ICER, 4, HOST_REGISTER_CLR, ISER),
+    REG(NVIC_Type, ISER, 4, HOST_REGISTER_SET, ISER),
+    REG(NVIC_Type, ICPR, 4, HOST_REGISTER_CLR, ISPR),
+    REG(NVIC_Type, ISPR, 4, HOST_REGISTER_SET, ISPR),
+};
+
+#define BLOCK(base, table) { (uintptr_t)(base), table, sizeof(table) / sizeof(table[0]) }
+
+static const host_register_block_t blocks[] = {
+    BLOCK(RTC, rtc_registers),
+    BLOCK(EIC, eic_registers),
+    BLOCK(&PORT->Group[0], port_group_registers),
+    BLOCK(&PORT->Group[1], port_group_registers),
+    BLOCK(&PORT_IOBUS->Group[0], port_group_registers),
+    BLOCK(&PORT_IOBUS->Group[1], port_group_registers),
+    BLOCK(DMAC, dmac_registers),
+    BLOCK(SERCOM1, sercom_i2cm_registers),
+    BLOCK(SERCOM3, sercom_usart_registers),
+    BLOCK(ADC, adc_registers),
+    BLOCK(TC0, tc0_registers),
+    BLOCK(TC1, tc1_registers),
+    BLOCK(TC2, tc2_registers),
+    BLOCK(TC3, tc3_registers),
+    BLOCK(NVIC, nvic_registers),
+};
+
+static const size_t num_blocks = sizeof(blocks) / sizeof(blocks[0]);
+
+static bool trapping = false;
+static bool applying = false;
+static uint32_t unlock_depth = 0;
+
+// State carried from a write fault to the single-step trap that follows it.
+static const host_register_block_t *pending_block;
+static const host_register_t *pending_register;
+static uint32_t pending_before;
+static uint32_t pending_target_before;
+
+static void protect_blocks(int prot) {
+    for (size_t i = 0; i < num_blocks; i++) {
+        mprotect((void *)(blocks[i].base & ~(uintptr_t)(HOST_PAGE_SIZE - 1)), HOST_PAGE_SIZE, prot);
+    }
+}
+
+static bool in_protected_page(uintptr_t addr) {
+    for (size_t i = 0; i < num_blocks; i++) {
+        if ((addr & ~(uintptr_t)(HOST_PAGE_SIZE - 1)) == (blocks[i].base & ~(uintptr_t)(HOST_PAGE_SIZE - 1))) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t read_register(uintptr_t addr, uint8_t width) {
+    switch (width) {
+        case 1: return *(volatile uint8_t *)addr;
+        case 2: return *(volatile uint16_t *)addr;
+        default: return *(volatile uint32_t *)addr;
+    }
+}
+
+static void write_register(uintptr_t addr, uint8_t width, uint32_t value) {
+    switch (width) {
+        case 1: *(volatile uint8_t *)addr = value; break;
+        case 2: *(volatile uint16_t *)addr = value; break;
+        default: *(volatile uint32_t *)addr = value; break;
+    }
+}
+
+static void find_register(uintptr_t addr) {
+    pending_block = NULL;
+    pending_register = NULL;
+
+    for (size_t i = 0; i < num_blocks; i++) {
+        for (size_t j = 0; j < blocks[i].count; j++) {
+            const host_register_t *r = &blocks[i].registers[j];
+            uintptr_t reg = blocks[i].base + r->offset;
+            if (addr >= reg && addr < reg + r->width) {
+                pending_block = &blocks[i];
+                pending_register = r;
+                pending_before = read_register(reg, r->width);
+                pending_target_before = read_register(blocks[i].base + r->target, r->width);
+                return;
+            }
+        }
+    }
+}
+
+static void apply_pending_write(void) {
+    const host_register_t *r = pending_register;
+    uintptr_t reg = pending_block->base + r->offset;
+    uintptr_t target = pending_block->base + r->target;
+    uint32_t written = read_register(reg, r->width);
+    uint32_t value;
+
+    switch (r->kind) {
+        case HOST_REGISTER_W1C:
+            write_register(reg, r->width, pending_before & ~written);
+            if (r->hook) r->hook(pending_before, written);
+            return;
+        case HOST_REGISTER_PLAIN:
+            if (r->hook) r->hook(pending_before, written);
+            return;
+        case HOST_REGISTER_SET:
+            value = pending_target_before | written;
+            break;
+        case HOST_REGISTER_CLR:
+            value = pending_target_before & ~written;
+            break;
+        case HOST_REGISTER_TGL:
+        default:
+            value = pending_target_before ^ written;
+            break;
+    }
+
+    // Set/clear/toggle registers read back as the mask they modify.
+    write_register(target, r->width, value);
+    write_register(reg, r->width, value);
+    if (r->hook) r->hook(pending_target_before, written);
+}
+
+static void write_fault_handler(int sig, siginfo_t *info, void *context) {
+    ucontext_t *uc = context;
+    uintptr_t addr = (uintptr_t)info->si_addr;
+
+    if (!trapping || !in_protected_page(addr)) {
+        // Not one of ours: restore the default action and let the fault happen for real.
+        signal(sig, SIG_DFL);
+        return;
+    }
+
+    find_register(addr);
+    protect_blocks(PROT_READ | PROT_WRITE);
+    // Let the store execute, then trap again right after it.
+    uc->uc_mcontext.gregs[REG_EFL] |= HOST_TRAP_FLAG;
+}
+
+static void single_step_handler(int sig, siginfo_t *info, void *context) {
+    ucontext_t *uc = context;
+    (void)sig;
+    (void)info;
+
+    uc->uc_mcontext.gregs[REG_EFL] &= ~HOST_TRAP_FLAG;
+    if (pending_register) {
+        // Hooks may unlock and lock, but the pages stay open until the write has been applied.
+        applying = true;
+        apply_pending_write();
+        applying = false;
+        pending_register = NULL;
+    }
+    if (!unlock_depth) protect_blocks(PROT_READ);
+}
+
+bool host_registers_init(void) {
+#if defined(__x86_64__) && defined(__linux__)
+    struct sigaction sa;
+
+    if (sysconf(_SC_PAGESIZE) != HOST_PAGE_SIZE) return false;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_flags = SA_SIGINFO;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_sigaction = write_fault_handler;
+    sigaction(SIGSEGV, &sa, NULL);
+    sa.sa_sigaction = single_step_handler;
+    sigaction(SIGTRAP, &sa, NULL);
+
+    trapping = true;
+    if (!unlock_depth) protect_blocks(PROT_READ);
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+void host_registers_unlock(void) {
+    if (unlock_depth++ == 0 && trapping) protect_blocks(PROT_READ | PROT_WRITE);
+}
+
+void host_registers_lock(void) {
+    if (--unlock_depth == 0 && trapping && !applying) protect_blocks(PROT_READ);
+}
+
+void host_registers_write(uintptr_t addr, uint8_t width, uint32_t value) {
+    const host_register_block_t *block = pending_block;
+    const host_register_t *reg = pending_register;
+    uint32_t before = pending_before, target_before = pending_target_before;
+
+    // This may run from inside a hook, in the middle of applying another write.
+    host_registers_unlock();
+    find_register(addr);
+    write_register(addr, width, value);
+    if (pending_register) apply_pending_write();
+    pending_block = block;
+    pending_register = reg;
+    pending_before = before;
+    pending_target_before = target_before;
+    host_registers_lock();
+}
@@ -0,0 +1,58 @@
+/*
+ * Register write semantics for the host peripheral stand-ins.
+ *
+ * Plain RAM gets interrupt flag and set/clear registers wrong: on the chip, writing a 1
+ * to INTFLAG clears that flag, and INTENSET/INTENCLR or OUTSET/OUTCLR/OUTTGL modify a
+ * shared mask. Code like _ext_irq_handler, which loops until INTFLAG reads zero, would
+ * never terminate. The pages holding the registers listed in host_registers.c are kept
+ * read-only while firmware runs; each store faults, is single-stepped, and is then
+ * folded into its target register according to the hardware semantics. Registers whose
+ * writes start something, like the I2C master's ADDR and DATA, also get a hook that lets
+ * a peripheral model react.
+ */
+#ifndef _HOST_REGISTERS_H_
+#define _HOST_REGISTERS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    HOST_REGISTER_W1C = 0,  ///< writing 1 clears the bit (INTFLAG, TAMPID)
+    HOST_REGISTER_SET,      ///< writing 1 sets the bit in the target register
+    HOST_REGISTER_CLR,      ///< writing 1 clears the bit in the target register
+    HOST_REGISTER_TGL,      ///< writing 1 toggles the bit in the target register
+    HOST_REGISTER_PLAIN,    ///< stores the value as written; only useful with a hook
+} host_register_kind_t;
+
+/// Called after a write has taken effect, with the register's value before it and the value
+/// written. Hooks run inside the trap handler: they may change registers directly and call
+/// host_registers_write(), but must not run interrupt handlers.
+typedef void (*host_register_hook_t)(uint32_t before, uint32_t written);
+
+typedef struct {
+    uint16_t offset;
+    uint8_t width;
+    host_register_kind_t kind;
+    uint16_t target;        ///< offset of the register a SET/CLR/TGL write modifies
+    host_register_hook_t hook;
+} host_register_t;
+
+/** @brief Installs the fault handlers and write-protects the modeled register pages.
+  * @return false if write trapping is unavailable on this host; registers then behave as plain RAM.
+  */
+bool host_registers_init(void);
+
+/** @brief Lets the simulator write registers directly, bypassing hardware semantics.
+  * Calls nest; every unlock must be paired with host_registers_lock().
+  */
+void host_registers_unlock(void);
+void host_registers_lock(void);
+
+/** @brief Stores to memory the way firmware would, with the hardware semantics and hook of any
+  * modeled register at that address. For bus masters like the DMAC.
+  * @param addr The address, which need not be a register.
+  * @param width The access size in bytes: 1, 2 or 4.
+  */
+void host_registers_write(uintptr_t addr, uint8_t width, uint32_t value);
+
+#endif /* _HOST_REGISTERS_H_ */
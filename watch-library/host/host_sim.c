@@ -0,0 +1,523 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "hpl_rtc_config.h"
+#include "utils_assert.h"
+#include "watch_energy.h"
+#include "host_energy.h"
+#include "host_adc.h"
+#include "host_i2c.h"
+#include "host_registers.h"
+#include "host_sim.h"
+#include "host_systick.h"
+#include "host_tc.h"
+#include "host_uart.h"
+
+#define HOST_SIM_DEFAULT_SECONDS 60
+#define HOST_SIM_MAX_SCRIPTED_EDGES 64
+// What a basic block of firmware costs the core, on average: a handful of Thumb instructions at
+// about a cycle each, and two more for the branch out. An estimate to calibrate against a board;
+// WATCH_HOST_BLOCK_CYCLES overrides it.
+#define HOST_SIM_DEFAULT_BLOCK_CYCLES 6
+// An interrupt that stays pending after this many back-to-back handler calls is a
+// firmware bug on the chip too (the core would never get back to thread mode).
+#define HOST_SIM_MAX_REENTRY 16
+// IPSR holds the exception number, and external interrupts start at 16.
+#define HOST_SIM_IRQ_EXCEPTION_BASE 16
+
+void RTC_Handler(void) __attribute__((weak));
+void EIC_Handler(void) __attribute__((weak));
+void DMAC_Handler(void) __attribute__((weak));
+void SERCOM1_Handler(void) __attribute__((weak));
+void ADC_Handler(void) __attribute__((weak));
+void SERCOM3_Handler(void) __attribute__((weak));
+void TC0_Handler(void) __attribute__((weak));
+void TC1_Handler(void) __attribute__((weak));
+
+volatile uint32_t host_primask = 0;
+volatile uint32_t host_ipsr = 0;
+
+typedef struct {
+    IRQn_Type irq;
+    void (*handler)(void);
+    watch_energy_region_t region;
+} host_sim_vector_t;
+
+// In the order deliver_pending() takes them when several are pending at once.
+static const host_sim_vector_t vectors[] = {
+    { RTC_IRQn, RTC_Handler, WATCH_ENERGY_RTC_HANDLER },
+    { EIC_IRQn, EIC_Handler, WATCH_ENERGY_EIC_HANDLER },
+    { DMAC_IRQn, DMAC_Handler, WATCH_ENERGY_DMAC_HANDLER },
+    { SERCOM1_IRQn, SERCOM1_Handler, WATCH_ENERGY_SERCOM1_HANDLER },
+    { ADC_IRQn, ADC_Handler, WATCH_ENERGY_ADC_HANDLER },
+    { SERCOM3_IRQn, SERCOM3_Handler, WATCH_ENERGY_SERCOM3_HANDLER },
+    { TC0_IRQn, TC0_Handler, WATCH_ENERGY_TC0_HANDLER },
+    { TC1_IRQn, TC1_Handler, WATCH_ENERGY_TC1_HANDLER },
+};
+
+typedef struct {
+    uint64_t cycle;
+    uint8_t extint;
+    bool level;
+} host_sim_edge_t;
+
+// Simulated time is kept in CPU cycles; CLK_RTC ticks are derived from it.
+static uint64_t cycles = 0;
+static uint64_t limit_cycles = 0;
+static uint64_t delay_cycles = 0;
+static uint64_t wake_count = 0;
+static bool cpu_active = true;
+static struct timespec wall_start;
+
+// Time spent running firmware is charged at a flat cost per basic block, whenever firmware calls
+// into the simulator.
+static uint32_t cycles_per_block;
+static uint64_t firmware_blocks = 0;
+static uint64_t charged_blocks = 0;
+
+static host_sim_edge_t scripted_edges[HOST_SIM_MAX_SCRIPTED_EDGES];
+static size_t num_scripted_edges = 0;
+static size_t next_scripted_edge = 0;
+
+static uint64_t ticks_at(uint64_t cycle) {
+    return cycle * HOST_SIM_RTC_HZ / CONF_CPU_FREQUENCY;
+}
+
+uint64_t host_sim_cycle_of_tick(uint64_t tick) {
+    return (tick * CONF_CPU_FREQUENCY + HOST_SIM_RTC_HZ - 1) / HOST_SIM_RTC_HZ;
+}
+
+static void host_sim_finish(void) {
+    struct timespec wall_end;
+    clock_gettime(CLOCK_MONOTONIC, &wall_end);
+    double wall = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+
+    fprintf(stderr, "host: %llu simulated seconds, %llu wakes, %llu delay cycles, %.3f s wall clock\n",
+            (unsigned long long)(cycles / CONF_CPU_FREQUENCY), (unsigned long long)wake_count,
+            (unsigned long long)delay_cycles, wall);
+    host_i2c_stats_t i2c = host_i2c_get_stats();
+    if (i2c.starts) {
+        fprintf(stderr, "host: %lu I2C transactions, %lu starts, %lu bytes\n", (unsigned long)i2c.transactions,
+                (unsigned long)i2c.starts, (unsigned long)i2c.bytes);
+    }
+    host_energy_report_totals();
+    exit(0);
+}
+
+static bool irq_enabled(IRQn_Type irq) {
+    return NVIC->ISER[0] & (1ul << irq);
+}
+
+static uint32_t rtc_count_period(void) {
+    uint16_t ctrla = RTC->MODE0.CTRLA.reg;
+    uint8_t prescaler = (ctrla & RTC_MODE0_CTRLA_PRESCALER_Msk) >> RTC_MODE0_CTRLA_PRESCALER_Pos;
+
+    if (!(ctrla & RTC_MODE0_CTRLA_ENABLE) || prescaler == 0) return 0;
+
+    return 1ul << (prescaler - 1);
+}
+
+static bool rtc_clock_mode(void) {
+    return RTC->MODE2.CTRLA.bit.MODE == RTC_MODE2_CTRLA_MODE_CLOCK_Val;
+}
+
+// MODE2 keeps the date in CLOCK/ALARM bitfields; the simulator steps it through time_t.
+static time_t clock_to_time(uint32_t clock) {
+    RTC_MODE2_CLOCK_Type c = {.reg = clock};
+    struct tm tm = {
+        .tm_year = CONF_RTC_REFERENCE_YEAR + c.bit.YEAR - 1900,
+        .tm_mon = c.bit.MONTH - 1,
+        .tm_mday = c.bit.DAY,
+        .tm_hour = c.bit.HOUR,
+        .tm_min = c.bit.MINUTE,
+        .tm_sec = c.bit.SECOND,
+    };
+    return timegm(&tm);
+}
+
+static uint32_t time_to_clock(time_t t) {
+    struct tm tm;
+    RTC_MODE2_CLOCK_Type c = {.reg = 0};
+
+    gmtime_r(&t, &tm);
+    c.bit.YEAR = tm.tm_year + 1900 - CONF_RTC_REFERENCE_YEAR;
+    c.bit.MONTH = tm.tm_mon + 1;
+    c.bit.DAY = tm.tm_mday;
+    c.bit.HOUR = tm.tm_hour;
+    c.bit.MINUTE = tm.tm_min;
+    c.bit.SECOND = tm.tm_sec;
+    return c.reg;
+}
+
+/// Returns how many clock seconds from now ALARM0 next matches under MASK0, or 0 for never.
+static uint64_t clock_alarm_distance(void) {
+    RTC_MODE2_ALARM_Type alarm = RTC->MODE2.Mode2Alarm[0].ALARM;
+    uint8_t sel = RTC->MODE2.Mode2Alarm[0].MASK.bit.SEL;
+    time_t now = clock_to_time(RTC->MODE2.CLOCK.reg);
+    uint32_t time_of_day = alarm.bit.HOUR * 3600 + alarm.bit.MINUTE * 60 + alarm.bit.SECOND;
+    static const uint32_t periods[] = {0, 60, 3600, 86400};
+
+    if (sel == 0) return 0;
+    if (sel <= 3) {
+        uint32_t target = time_of_day % periods[sel];
+        uint32_t d = (target + periods[sel] - now % periods[sel]) % periods[sel];
+        return d ? d : periods[sel];
+    }
+    if (sel >= RTC_MODE2_MASK_SEL_YYMMDDHHMMSS_Val) {
+        time_t t = clock_to_time(alarm.reg);
+        return t > now ? (uint64_t)(t - now) : 0;
+    }
+    // Day of month, optionally month: search forward a day at a time over four years.
+    for (time_t day = now / 86400; day <= now / 86400 + 4 * 366; day++) {
+        time_t t = day * 86400 + time_of_day;
+        struct tm tm;
+        if (t <= now) continue;
+        gmtime_r(&t, &tm);
+        if (tm.tm_mday != alarm.bit.DAY) continue;
+        if (sel == RTC_MODE2_MASK_SEL_MMDDHHMMSS_Val && tm.tm_mon + 1 != alarm.bit.MONTH) continue;
+        return t - now;
+    }
+    return 0;
+}
+
+/// Returns the CLK_RTC tick of the next enabled RTC interrupt and the INTFLAG bits it raises.
+static uint64_t next_rtc_event(uint16_t *flags) {
+    uint16_t inten = RTC->MODE0.INTENSET.reg;
+    uint32_t period = rtc_count_period();
+    uint64_t now = ticks_at(cycles);
+    uint64_t next = UINT64_MAX;
+
+    *flags = 0;
+    if (!period || !irq_enabled(RTC_IRQn)) return next;
+
+    for (uint8_t n = 0; n < 8; n++) {
+        if (!(inten & (1 << n))) continue;
+        // PERn comes on the 0-to-1 edge of prescaler bit n + 2, half a period after it wraps.
+        uint64_t per = 8ull << n;
+        uint64_t t = ((now + per / 2) / per + 1) * per - per / 2;
+        if (t < next) {
+            next = t;
+            *flags = 0;
+        }
+        if (t == next) *flags |= 1 << n;
+    }
+
+    if (inten & RTC_MODE0_INTFLAG_CMP0) {
+        uint64_t diff;
+        if (rtc_clock_mode()) {
+            diff = clock_alarm_distance();
+            if (!diff) return next;
+        } else {
+            diff = (uint32_t)(RTC->MODE0.COMP[0].reg - RTC->MODE0.COUNT.reg);
+            if (!diff) diff = 1ull << 32;
+        }
+        uint64_t t = (now / period + diff) * period;
+        if (t < next) {
+            next = t;
+            *flags = 0;
+        }
+        if (t == next) *flags |= RTC_MODE0_INTFLAG_CMP0;
+    }
+
+    return next;
+}
+
+static void advance_to(uint64_t cycle) {
+    uint32_t period = rtc_count_period();
+
+    if (period) {
+        uint64_t elapsed = ticks_at(cycle) / period - ticks_at(cycles) / period;
+        host_registers_unlock();
+        if (rtc_clock_mode()) {
+            if (elapsed) RTC->MODE2.CLOCK.reg = time_to_clock(clock_to_time(RTC->MODE2.CLOCK.reg) + elapsed);
+        } else {
+            RTC->MODE0.COUNT.reg += (uint32_t)elapsed;
+        }
+        host_registers_lock();
+    }
+    host_tc_advance(cycles, cycle);
+    if (cpu_active) host_systick_advance(cycle - cycles);
+    host_energy_integrate(cycle - cycles, cpu_active);
+    cycles = cycle;
+}
+
+static void raise_rtc(uint16_t flags) {
+    host_registers_unlock();
+    RTC->MODE0.INTFLAG.reg |= flags;
+    host_registers_lock();
+    NVIC->ISPR[0] |= 1ul << RTC_IRQn;
+}
+
+void host_sim_trigger_extint(uint8_t extint) {
+    // As on the chip, the flag is raised even while the interrupt is masked.
+    host_registers_unlock();
+    EIC->INTFLAG.reg |= 1ul << extint;
+    host_registers_lock();
+
+    if (!(EIC->INTENSET.reg & (1ul << extint))) return;
+    NVIC->ISPR[0] |= 1ul << EIC_IRQn;
+    host_sim_deliver_pending();
+}
+
+void host_sim_set_extint_level(uint8_t extint, bool level) {
+    // Every pin muxed to the EIC (peripheral function A) drives EXTINT[pin % 16].
+    host_registers_unlock();
+    for (uint8_t group = 0; group < 2; group++) {
+        for (uint8_t pin = 0; pin < 32; pin++) {
+            if (pin % 16 != extint || !PORT->Group[group].PINCFG[pin].bit.PMUXEN) continue;
+            uint8_t pmux = PORT->Group[group].PMUX[pin / 2].reg;
+            if ((pin & 1 ? pmux >> 4 : pmux & 0xF) != 0) continue;
+            // IN is read-only to firmware.
+            volatile uint32_t *in = (volatile uint32_t *)&PORT->Group[group].IN.reg;
+            if (level) *in |= 1ul << pin;
+            else *in &= ~(1ul << pin);
+            *(volatile uint32_t *)&PORT_IOBUS->Group[group].IN.reg = *in;
+        }
+    }
+    host_registers_lock();
+
+    uint8_t sense = (EIC->CONFIG[extint / 8].reg >> ((extint % 8) * 4)) & EIC_CONFIG_SENSE0_Msk;
+    switch (sense) {
+        case EIC_CONFIG_SENSE0_RISE_Val:
+        case EIC_CONFIG_SENSE0_HIGH_Val:
+            if (level) host_sim_trigger_extint(extint);
+            break;
+        case EIC_CONFIG_SENSE0_FALL_Val:
+        case EIC_CONFIG_SENSE0_LOW_Val:
+            if (!level) host_sim_trigger_extint(extint);
+            break;
+        case EIC_CONFIG_SENSE0_BOTH_Val:
+            host_sim_trigger_extint(extint);
+            break;
+    }
+}
+
+/// Whether a peripheral still holds its interrupt line up after its handler returns. The RTC, EIC
+/// and SERCOM1 handlers are taken again until they clear every enabled flag.
+static bool line_asserted(IRQn_Type irq) {
+    switch (irq) {
+        case RTC_IRQn: return RTC->MODE0.INTFLAG.reg & RTC->MODE0.INTENSET.reg;
+        case EIC_IRQn: return EIC->INTFLAG.reg & EIC->INTENSET.reg;
+        case SERCOM1_IRQn: return SERCOM1->I2CM.INTFLAG.reg & SERCOM1->I2CM.INTENSET.reg;
+        default: return false;
+    }
+}
+
+/// Returns the interrupts that are pended in the NVIC and enabled there, whether or not PRIMASK
+/// lets them be taken; any of them ends __WFI().
+static uint32_t pending_irqs(void) {
+    uint32_t pending = NVIC->ISPR[0] & NVIC->ISER[0];
+    uint32_t handled = 0;
+
+    for (size_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) handled |= 1ul << vectors[i].irq;
+    return pending & handled;
+}
+
+static bool step(uint64_t until);
+
+static void run_until(uint64_t target) {
+    while (cycles < target) step(target);
+}
+
+/// Counts a basic block of firmware. The host build compiles every firmware source with
+/// -fsanitize-coverage=trace-pc, which calls this on each edge into a block; host sources are not
+/// instrumented, so the simulator's own work goes uncounted.
+void __sanitizer_cov_trace_pc(void) {
+    firmware_blocks++;
+}
+
+/// Charges the blocks firmware has run since the last charge to simulated time, as active cycles.
+/// Interrupts that come due meanwhile are delivered once the charge is made, unless they are masked.
+static void charge_firmware(void) {
+    bool was_active = cpu_active;
+    uint64_t blocks = firmware_blocks - charged_blocks;
+
+    charged_blocks = firmware_blocks;
+    // A handler taken while the core sleeps runs with it awake.
+    cpu_active = true;
+    run_until(cycles + blocks * cycles_per_block);
+    cpu_active = was_active;
+}
+
+static void take(const host_sim_vector_t *vector) {
+    NVIC_ClearPendingIRQ(vector->irq);
+    for (int i = 0; i < HOST_SIM_MAX_REENTRY; i++) {
+        host_ipsr = vector->irq + HOST_SIM_IRQ_EXCEPTION_BASE;
+        WATCH_ENERGY_ENTER(vector->region);
+        if (vector->handler) vector->handler();
+        charge_firmware();
+        WATCH_ENERGY_EXIT(vector->region);
+        host_ipsr = 0;
+        if (!line_asserted(vector->irq)) break;
+    }
+}
+
+/// Runs handlers for interrupts pended in the NVIC, by a peripheral model or by firmware through
+/// NVIC_SetPendingIRQ(). Nothing is taken while PRIMASK is set or inside another handler, since
+/// every interrupt shares the default priority; they stay pending until __enable_irq() or the
+/// handler's return.
+/// @return true if a handler ran.
+static bool deliver_pending(void) {
+    bool delivered = false;
+
+    if (host_primask || host_ipsr) return false;
+    for (int i = 0; i < HOST_SIM_MAX_REENTRY; i++) {
+        uint32_t pending = pending_irqs();
+        if (!pending) break;
+        for (size_t v = 0; v < sizeof(vectors) / sizeof(vectors[0]); v++) {
+            if (!(pending & (1ul << vectors[v].irq))) continue;
+            take(&vectors[v]);
+            delivered = true;
+        }
+    }
+
+    return delivered;
+}
+
+void host_sim_deliver_pending(void) {
+    charge_firmware();
+    deliver_pending();
+}
+
+void host_sim_sync(void) {
+    charge_firmware();
+}
+
+/// Advances to the next event at or before cycle `until` and delivers it, unless interrupts are
+/// masked. @return true if the event would wake the core.
+static bool step(uint64_t until) {
+    uint16_t rtc_flags;
+    uint64_t rtc_tick = next_rtc_event(&rtc_flags);
+    uint64_t rtc_cycle = rtc_tick == UINT64_MAX ? UINT64_MAX : host_sim_cycle_of_tick(rtc_tick);
+    uint64_t edge_cycle = next_scripted_edge < num_scripted_edges ? scripted_edges[next_scripted_edge].cycle : UINT64_MAX;
+    uint64_t i2c_cycle = host_i2c_next_event();
+    uint64_t adc_cycle = host_adc_next_event();
+    uint64_t uart_cycle = host_uart_next_event();
+    uint64_t tc_cycle = host_tc_next_event();
+    uint64_t t = until;
+    bool woke = false;
+
+    if (rtc_cycle < t) t = rtc_cycle;
+    if (edge_cycle < t) t = edge_cycle;
+    if (i2c_cycle < t) t = i2c_cycle;
+    if (adc_cycle < t) t = adc_cycle;
+    if (uart_cycle < t) t = uart_cycle;
+    if (tc_cycle < t) t = tc_cycle;
+    if (limit_cycles < t) {
+        advance_to(limit_cycles);
+        host_sim_finish();
+    }
+
+    advance_to(t);
+
+    while (next_scripted_edge < num_scripted_edges && scripted_edges[next_scripted_edge].cycle == t) {
+        host_sim_set_extint_level(scripted_edges[next_scripted_edge].extint, scripted_edges[next_scripted_edge].level);
+        next_scripted_edge++;
+        woke = true;
+    }
+    if (rtc_cycle == t) raise_rtc(rtc_flags);
+    if (i2c_cycle == t) {
+        host_i2c_complete();
+        // A byte the DMAC took raises no enabled flag, and leaves the core asleep.
+        if (line_asserted(SERCOM1_IRQn)) NVIC->ISPR[0] |= 1ul << SERCOM1_IRQn;
+    }
+    // The ADC pends its interrupt in the NVIC; a conversion that raises none leaves the core asleep.
+    if (adc_cycle == t) host_adc_update();
+    if (uart_cycle == t) host_uart_update();
+    if (tc_cycle == t) host_tc_update();
+    if (pending_irqs()) woke = true;
+    deliver_pending();
+
+    return woke;
+}
+
+void host_sim_wait_for_interrupt(void) {
+    uint64_t polled = host_i2c_take_polled_cycles();
+
+    charge_firmware();
+    // Polled I2C transfers finished instantly; the core would have been busy for this long.
+    delay_cycles += polled;
+    run_until(cycles + polled);
+    host_energy_sleep();
+    // With PRIMASK set the core still wakes for a pending interrupt, but its handler waits for
+    // __enable_irq().
+    if (!pending_irqs()) {
+        cpu_active = false;
+        while (!step(UINT64_MAX));
+        cpu_active = true;
+    }
+    deliver_pending();
+    wake_count++;
+}
+
+void host_sim_advance_cycles(uint32_t n) {
+    charge_firmware();
+    delay_cycles += n;
+    run_until(cycles + n);
+}
+
+uint64_t host_sim_get_ticks(void) {
+    return ticks_at(cycles);
+}
+
+uint64_t host_sim_get_cycles(void) {
+    return cycles;
+}
+
+uint64_t host_sim_get_delay_cycles(void) {
+    return delay_cycles;
+}
+
+uint64_t host_sim_get_wake_count(void) {
+    return wake_count;
+}
+
+static int compare_edges(const void *a, const void *b) {
+    const host_sim_edge_t *edge_a = a, *edge_b = b;
+
+    if (edge_a->cycle != edge_b->cycle) return edge_a->cycle < edge_b->cycle ? -1 : 1;
+    // A press and its release at the same instant happen in that order.
+    if (edge_a->extint == edge_b->extint) return (int)edge_b->level - (int)edge_a->level;
+    return 0;
+}
+
+/// Parses `second:extint[:hold]` entries. Each one presses the button at `second` and releases it
+/// `hold` seconds later (at once if omitted).
+static void parse_scripted_edges(const char *script) {
+    while (script && *script && num_scripted_edges + 2 <= HOST_SIM_MAX_SCRIPTED_EDGES) {
+        double second, hold = 0;
+        unsigned long extint;
+        if (sscanf(script, "%lf:%lu:%lf", &second, &extint, &hold) < 2 || second < 0 || hold < 0 || extint > 15) {
+            fprintf(stderr, "host: ignoring malformed WATCH_HOST_EXTINT entry '%s'\n", script);
+            break;
+        }
+        scripted_edges[num_scripted_edges++] = (host_sim_edge_t){
+            .cycle = (uint64_t)(second * CONF_CPU_FREQUENCY), .extint = extint, .level = true };
+        scripted_edges[num_scripted_edges++] = (host_sim_edge_t){
+            .cycle = (uint64_t)((second + hold) * CONF_CPU_FREQUENCY), .extint = extint, .level = false };
+        script = strchr(script, ',');
+        if (script) script++;
+    }
+    qsort(scripted_edges, num_scripted_edges, sizeof(scripted_edges[0]), compare_edges);
+}
+
+__attribute__((constructor)) static void host_sim_init(void) {
+    const char *seconds = getenv("WATCH_HOST_SECONDS");
+    const char *block_cycles = getenv("WATCH_HOST_BLOCK_CYCLES");
+
+    limit_cycles = (uint64_t)(seconds ? strtoull(seconds, NULL, 10) : HOST_SIM_DEFAULT_SECONDS) * CONF_CPU_FREQUENCY;
+    parse_scripted_edges(getenv("WATCH_HOST_EXTINT"));
+    cycles_per_block = block_cycles ? strtoul(block_cycles, NULL, 10) : HOST_SIM_DEFAULT_BLOCK_CYCLES;
+    clock_gettime(CLOCK_MONOTONIC, &wall_start);
+}
+
+void assert(const bool condition, const char *const file, const int line) {
+    if (!condition) {
+        fprintf(stderr, "host: assertion failed at %s:%d\n", file, line);
+        abort();
+    }
+}
@@ -0,0 +1,74 @@
+/*
+ * Time and interrupt simulation for the host build.
+ *
+ * __WFI() (via sleep()) jumps straight to the next enabled interrupt, and delay_ms()/delay_us()
+ * advance the clock by the requested number of CPU cycles. Code that runs costs time too: the
+ * firmware sources are built to count the basic blocks they execute, and each block is charged
+ * a flat number of core cycles whenever firmware calls into the simulator (sleeping, delaying,
+ * unmasking interrupts, entering or leaving an energy region, or returning from a handler).
+ * Library calls like sprintf() are not counted. Interrupts that come due are delivered by
+ * calling the matching *_Handler() with the peripheral's INTFLAG register raised, or held
+ * pending while firmware has them masked with __disable_irq().
+ *
+ * Environment variables drive a run without touching the app:
+ *   WATCH_HOST_SECONDS       simulated seconds to run before exiting (default 60)
+ *   WATCH_HOST_EXTINT        comma-separated "second:extint" button edges, e.g. "3:6,5:7"
+ *   WATCH_HOST_BLOCK_CYCLES  core cycles charged per basic block of firmware (default 6)
+ */
+#ifndef _HOST_SIM_H_
+#define _HOST_SIM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/// CLK_RTC runs from the 1.024 kHz output of OSCULP32K / XOSC32K.
+#define HOST_SIM_RTC_HZ 1024
+
+/** @brief Returns simulated time since reset, in CLK_RTC ticks. */
+uint64_t host_sim_get_ticks(void);
+
+/** @brief Returns simulated time since reset, in CPU cycles. */
+uint64_t host_sim_get_cycles(void);
+
+/** @brief Returns the first cycle at which the given CLK_RTC tick has happened. */
+uint64_t host_sim_cycle_of_tick(uint64_t tick);
+
+/** @brief Returns the number of CPU cycles the firmware has spent busy-waiting in delays. */
+uint64_t host_sim_get_delay_cycles(void);
+
+/** @brief Returns the number of times the core has woken from __WFI(). */
+uint64_t host_sim_get_wake_count(void);
+
+/** @brief Charges the time firmware has run since it last called into the simulator, so that
+  * host_sim_get_cycles() includes it.
+  */
+void host_sim_sync(void);
+
+/** @brief Advances simulated time by the given number of CPU cycles, delivering any
+  * interrupts that come due on the way, as they would on the chip.
+  */
+void host_sim_advance_cycles(uint32_t cycles);
+
+/** @brief Raises an external interrupt line, and runs the EIC handler if it is enabled and not masked.
+  * @param extint The EXTINT line, 0-15. The buttons are EXTINT5 (ALARM), 6 (LIGHT) and 7 (MODE).
+  */
+void host_sim_trigger_extint(uint8_t extint);
+
+/** @brief Drives every pin muxed to an EXTINT line, and raises the interrupt if the EIC is set
+  * to sense that edge.
+  * @param extint The EXTINT line, 0-15.
+  * @param level true for a pressed button.
+  */
+void host_sim_set_extint_level(uint8_t extint, bool level);
+
+/** @brief Sleeps until an enabled interrupt is pending, and delivers it unless PRIMASK is set.
+  * Called from __WFI().
+  */
+void host_sim_wait_for_interrupt(void);
+
+/** @brief Runs the handlers of pending interrupts, if PRIMASK allows and no handler is running.
+  * Called when firmware unmasks interrupts.
+  */
+void host_sim_deliver_pending(void);
+
+#endif /* _HOST_SIM_H_ */
@@ -0,0 +1,59 @@
+/*
+ * Host replacement for hpl/systick/hpl_systick.c.
+ *
+ * _delay_cycles() on the chip spins on SysTick's free-running count; here it hands the cycle
+ * count to the simulator, which advances simulated time by the same amount.
+ */
+#include <hpl_time_measure.h>
+#include <hpl_delay.h>
+#include "host_registers.h"
+#include "host_sim.h"
+#include "host_systick.h"
+
+void _system_time_init(void *const hw) {
+    (void)hw;
+    SysTick->LOAD = (0xFFFFFF << SysTick_LOAD_RELOAD_Pos);
+    SysTick->CTRL = (1 << SysTick_CTRL_ENABLE_Pos) | (1 << SysTick_CTRL_CLKSOURCE_Pos);
+}
+
+void _delay_init(void *const hw) {
+    _system_time_init(hw);
+}
+
+void _system_time_deinit(void *const hw) {
+    (void)hw;
+    SysTick->CTRL &= ~SysTick_CTRL_ENABLE_Msk;
+}
+
+system_time_t _system_time_get(const void *const hw) {
+    (void)hw;
+    return (system_time_t)SysTick->VAL;
+}
+
+system_time_t _system_time_get_max_time_value(const void *const hw) {
+    (void)hw;
+    return 0xFFFFFF;
+}
+
+void _delay_cycles(void *const hw, uint32_t cycles) {
+    (void)hw;
+    host_sim_advance_cycles(cycles);
+}
+
+void host_systick_advance(uint64_t elapsed) {
+    uint32_t ctrl = SysTick->CTRL;
+    uint32_t val = SysTick->VAL & SysTick_VAL_CURRENT_Msk;
+    uint64_t period = (SysTick->LOAD & SysTick_LOAD_RELOAD_Msk) + 1;
+
+    if (!(ctrl & SysTick_CTRL_ENABLE_Msk) || !elapsed) return;
+
+    host_registers_unlock();
+    if (elapsed <= val) {
+        SysTick->VAL = val - elapsed;
+    } else {
+        // Reaching zero reloads on the next clock.
+        SysTick->VAL = SysTick->LOAD - (elapsed - val - 1) % period;
+        SysTick->CTRL = ctrl | SysTick_CTRL_COUNTFLAG_Msk;
+    }
+    host_registers_lock();
+}
@@ -0,0 +1,18 @@
+/*
+ * SysTick for the host build.
+ *
+ * The counter runs down from LOAD at the CPU clock while the core is awake and stops while it
+ * sleeps, as the processor clock does on the chip. Reaching zero reloads it and sets COUNTFLAG.
+ * The simulator cannot see reads, so COUNTFLAG stays set until firmware writes CTRL; code that
+ * reads CTRL to clear it sees the flag again, as if SysTick had wrapped once more. The SysTick
+ * exception is not modeled.
+ */
+#ifndef _HOST_SYSTICK_H_
+#define _HOST_SYSTICK_H_
+
+#include <stdint.h>
+
+/** @brief Counts SysTick down by the given number of cycles of the core running. */
+void host_systick_advance(uint64_t elapsed);
+
+#endif /* _HOST_SYSTICK_H_ */
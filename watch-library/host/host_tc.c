@@ -0,0 +1,191 @@
+#include <stdbool.h>
+#include <string.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "host_dmac.h"
+#include "host_registers.h"
+#include "host_sim.h"
+#include "host_tc.h"
+
+#define HOST_TC_GCLK3_HZ 32768
+#define HOST_TC_CC_NUM 2
+
+static Tc *const instances[TC_INST_NUM] = { TC0, TC1, TC2, TC3 };
+static const uint8_t gclk_ids[TC_INST_NUM] = { TC0_GCLK_ID, TC1_GCLK_ID, TC2_GCLK_ID, TC3_GCLK_ID };
+static const uint16_t prescalers[] = { 1, 2, 4, 8, 16, 64, 256, 1024 };
+
+// The cycle at which each TC was last enabled, or UINT64_MAX while it is disabled.
+static uint64_t enable_cycles[TC_INST_NUM] = { UINT64_MAX, UINT64_MAX, UINT64_MAX, UINT64_MAX };
+
+static uint64_t top(Tc *tc) {
+    bool mfrq = tc->COUNT16.WAVE.bit.WAVEGEN == TC_WAVE_WAVEGEN_MFRQ_Val;
+
+    switch (tc->COUNT16.CTRLA.bit.MODE) {
+        case TC_CTRLA_MODE_COUNT8_Val: return tc->COUNT8.PER.reg;
+        case TC_CTRLA_MODE_COUNT16_Val: return mfrq ? tc->COUNT16.CC[0].reg : UINT16_MAX;
+        default: return mfrq ? tc->COUNT32.CC[0].reg : UINT32_MAX;
+    }
+}
+
+static uint32_t clock_hz(uint8_t index) {
+    return GCLK->PCHCTRL[gclk_ids[index]].bit.GEN == GCLK_PCHCTRL_GEN_GCLK3_Val ? HOST_TC_GCLK3_HZ : CONF_CPU_FREQUENCY;
+}
+
+/// Returns the first cycle after `now` at which the prescaled count of a TC enabled at cycle
+/// `enabled` reaches `clocks` modulo `period`, both in TC clocks, with `clocks` in 1..period.
+static uint64_t next_clock_after(uint8_t index, uint64_t enabled, uint64_t now, uint64_t clocks, uint64_t period) {
+    uint64_t hz = clock_hz(index);
+    uint64_t elapsed = (now - enabled) * hz / CONF_CPU_FREQUENCY;
+    uint64_t passes = elapsed >= clocks ? (elapsed - clocks) / period : 0;
+    uint64_t cycle;
+
+    do {
+        cycle = enabled + ((clocks + passes * period) * CONF_CPU_FREQUENCY + hz - 1) / hz;
+        passes++;
+    } while (cycle <= now);
+
+    return cycle;
+}
+
+/// Returns the first cycle after `now` at which a TC overflows, or UINT64_MAX while it is disabled.
+static uint64_t next_overflow_after(uint8_t index, uint64_t now) {
+    Tc *tc = instances[index];
+    uint64_t period;
+
+    if (enable_cycles[index] == UINT64_MAX) return UINT64_MAX;
+    // In TC clocks; the overflow comes as the counter wraps from TOP.
+    period = (top(tc) + 1) * prescalers[tc->COUNT16.CTRLA.bit.PRESCALER];
+    return next_clock_after(index, enable_cycles[index], now, period, period);
+}
+
+static uint32_t compare_value(Tc *tc, uint8_t channel) {
+    switch (tc->COUNT16.CTRLA.bit.MODE) {
+        case TC_CTRLA_MODE_COUNT8_Val: return tc->COUNT8.CC[channel].reg;
+        case TC_CTRLA_MODE_COUNT16_Val: return tc->COUNT16.CC[channel].reg;
+        default: return tc->COUNT32.CC[channel].reg;
+    }
+}
+
+/// Returns the first cycle after `now` at which the count reaches CCx, or UINT64_MAX while the
+/// TC is disabled or CCx is above TOP.
+static uint64_t next_match_after(uint8_t index, uint8_t channel, uint64_t now) {
+    Tc *tc = instances[index];
+    uint64_t prescaler = prescalers[tc->COUNT16.CTRLA.bit.PRESCALER];
+    uint64_t period = (top(tc) + 1) * prescaler;
+    uint64_t cc = compare_value(tc, channel);
+
+    if (enable_cycles[index] == UINT64_MAX || cc > top(tc)) return UINT64_MAX;
+    // A compare value of 0 is reached as the counter wraps.
+    return next_clock_after(index, enable_cycles[index], now, cc ? cc * prescaler : period, period);
+}
+
+uint64_t host_tc_next_overflow(uint8_t index) {
+    return next_overflow_after(index, host_sim_get_cycles());
+}
+
+static bool overflow_interrupt_enabled(uint8_t index) {
+    return instances[index]->COUNT16.INTENSET.reg & TC_INTENSET_OVF;
+}
+
+static bool match_interrupt_enabled(uint8_t index, uint8_t channel) {
+    return instances[index]->COUNT16.INTENSET.reg & (TC_INTENSET_MC0 << channel);
+}
+
+static uint8_t overflow_trigger(uint8_t index) {
+    return HOST_DMAC_TRIGSRC_TC0_OVF + index * HOST_DMAC_TRIGSRC_TC_STRIDE;
+}
+
+// Whether anything is told when the TC overflows, other than through the event system.
+static bool overflow_watched(uint8_t index) {
+    return overflow_interrupt_enabled(index) || host_dmac_waiting(overflow_trigger(index));
+}
+
+uint64_t host_tc_next_event(void) {
+    uint64_t next = UINT64_MAX;
+
+    for (uint8_t i = 0; i < TC_INST_NUM; i++) {
+        if (overflow_watched(i)) {
+            uint64_t cycle = host_tc_next_overflow(i);
+            if (cycle < next) next = cycle;
+        }
+        for (uint8_t channel = 0; channel < HOST_TC_CC_NUM; channel++) {
+            if (!match_interrupt_enabled(i, channel)) continue;
+            uint64_t cycle = next_match_after(i, channel, host_sim_get_cycles());
+            if (cycle < next) next = cycle;
+        }
+    }
+
+    return next;
+}
+
+static void raise(uint8_t index, uint8_t flags) {
+    host_registers_unlock();
+    instances[index]->COUNT16.INTFLAG.reg |= flags;
+    NVIC->ISPR[0] |= 1ul << (TC0_IRQn + index);
+    host_registers_lock();
+}
+
+void host_tc_update(void) {
+    uint64_t now = host_sim_get_cycles();
+
+    for (uint8_t i = 0; i < TC_INST_NUM; i++) {
+        if (enable_cycles[i] >= now) continue;
+        for (uint8_t channel = 0; channel < HOST_TC_CC_NUM; channel++) {
+            if (match_interrupt_enabled(i, channel) && next_match_after(i, channel, now - 1) == now) {
+                raise(i, TC_INTFLAG_MC0 << channel);
+            }
+        }
+        if (!overflow_watched(i) || next_overflow_after(i, now - 1) != now) continue;
+        host_dmac_trigger(overflow_trigger(i));
+        if (overflow_interrupt_enabled(i)) raise(i, TC_INTFLAG_OVF);
+    }
+}
+
+void host_tc_advance(uint64_t from, uint64_t to) {
+    for (uint8_t i = 0; i < TC_INST_NUM; i++) {
+        if (next_overflow_after(i, from) > to) continue;
+        host_registers_unlock();
+        instances[i]->COUNT16.INTFLAG.reg |= TC_INTFLAG_OVF;
+        host_registers_lock();
+    }
+}
+
+// READSYNC loads COUNT with the count at this cycle; the command field clears as it completes.
+static void ctrlbset_written(uint8_t index, uint32_t before, uint32_t written) {
+    Tc *tc = instances[index];
+    uint64_t enabled = enable_cycles[index];
+    uint64_t clocks;
+
+    (void)before;
+    if ((written & TC_CTRLBSET_CMD_Msk) != TC_CTRLBSET_CMD_READSYNC) return;
+    tc->COUNT16.CTRLBSET.reg &= ~TC_CTRLBSET_CMD_Msk;
+    if (enabled == UINT64_MAX) return;
+    clocks = (host_sim_get_cycles() - enabled) * clock_hz(index) / CONF_CPU_FREQUENCY
+             / prescalers[tc->COUNT16.CTRLA.bit.PRESCALER];
+    switch (tc->COUNT16.CTRLA.bit.MODE) {
+        case TC_CTRLA_MODE_COUNT8_Val: tc->COUNT8.COUNT.reg = clocks % (top(tc) + 1); break;
+        case TC_CTRLA_MODE_COUNT16_Val: tc->COUNT16.COUNT.reg = clocks % (top(tc) + 1); break;
+        default: tc->COUNT32.COUNT.reg = clocks % (top(tc) + 1); break;
+    }
+}
+
+static void ctrla_written(uint8_t index, uint32_t before, uint32_t written) {
+    if (written & TC_CTRLA_SWRST) {
+        memset((void *)instances[index], 0, sizeof(Tc));
+        enable_cycles[index] = UINT64_MAX;
+    } else if (!(written & TC_CTRLA_ENABLE)) {
+        enable_cycles[index] = UINT64_MAX;
+    } else if (!(before & TC_CTRLA_ENABLE)) {
+        enable_cycles[index] = host_sim_get_cycles();
+    }
+}
+
+void host_tc0_ctrla_written(uint32_t before, uint32_t written) { ctrla_written(0, before, written); }
+void host_tc1_ctrla_written(uint32_t before, uint32_t written) { ctrla_written(1, before, written); }
+void host_tc2_ctrla_written(uint32_t before, uint32_t written) { ctrla_written(2, before, written); }
+void host_tc3_ctrla_written(uint32_t before, uint32_t written) { ctrla_written(3, before, written); }
+
+void host_tc0_ctrlbset_written(uint32_t before, uint32_t written) { ctrlbset_written(0, before, written); }
+void host_tc1_ctrlbset_written(uint32_t before, uint32_t written) { ctrlbset_written(1, before, written); }
+void host_tc2_ctrlbset_written(uint32_t before, uint32_t written) { ctrlbset_written(2, before, written); }
+void host_tc3_ctrlbset_written(uint32_t before, uint32_t written) { ctrlbset_written(3, before, written); }
@@ -0,0 +1,47 @@
+/*
+ * TC0-TC3 for the host build, as far as their count, overflow and compare timing go.
+ *
+ * Setting CTRLA.ENABLE starts the counter from zero; from then on it overflows every TOP + 1
+ * prescaled GCLK_TCx clocks, where TOP is PER in 8-bit mode, CC0 in 16- and 32-bit modes with
+ * WAVE.WAVEGEN at MFRQ, and the counter's maximum otherwise. The clock is GCLK3's 32.768 kHz if
+ * the TC's peripheral channel takes generator 3, and the CPU clock for any other generator.
+ * The READSYNC command loads COUNT with the count at that cycle. Every overflow raises OVF in
+ * INTFLAG, and reaches other peripherals as events (see host_evsys.h) and as the TC's OVF DMA
+ * trigger; while INTENSET.OVF is set it also pends the TC's interrupt. While INTENSET.MCx is set,
+ * the count reaching CCx raises MCx and pends the interrupt. Changing TOP, a compare value or the
+ * prescaler while the counter runs takes effect as if it had held the new value since it was
+ * enabled.
+ */
+#ifndef _HOST_TC_H_
+#define _HOST_TC_H_
+
+#include <stdint.h>
+
+/** @brief Returns the first cycle after the current one at which a TC overflows.
+  * @param index The TC instance, 0 to 3.
+  * @return The cycle, or UINT64_MAX if the TC is disabled.
+  */
+uint64_t host_tc_next_overflow(uint8_t index);
+
+/** @brief Returns the cycle of the next overflow that raises an interrupt or a DMA request, or UINT64_MAX. */
+uint64_t host_tc_next_event(void);
+
+/** @brief Raises OVF, MCx and the OVF DMA request for each TC that overflows or matches now,
+  * where they are enabled.
+  */
+void host_tc_update(void);
+
+/** @brief Raises OVF in INTFLAG for each TC that overflowed after cycle `from`, up to `to`. */
+void host_tc_advance(uint64_t from, uint64_t to);
+
+// Register write hooks for host_registers.c.
+void host_tc0_ctrla_written(uint32_t before, uint32_t written);
+void host_tc1_ctrla_written(uint32_t before, uint32_t written);
+void host_tc2_ctrla_written(uint32_t before, uint32_t written);
+void host_tc3_ctrla_written(uint32_t before, uint32_t written);
+void host_tc0_ctrlbset_written(uint32_t before, uint32_t written);
+void host_tc1_ctrlbset_written(uint32_t before, uint32_t written);
+void host_tc2_ctrlbset_written(uint32_t before, uint32_t written);
+void host_tc3_ctrlbset_written(uint32_t before, uint32_t written);
+
+#endif /* _HOST_TC_H_ */
@@ -0,0 +1,137 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "saml22.h"
+#include "peripheral_clk_config.h"
+#include "host_dmac.h"
+#include "host_registers.h"
+#include "host_sim.h"
+#include "host_uart.h"
+
+// A start bit, eight data bits and a stop bit.
+#define HOST_UART_FRAME_BITS 10
+
+#define USART (SERCOM3->USART)
+
+static FILE *output = NULL;
+static uint32_t bytes_sent = 0;
+
+static uint64_t frame_end = UINT64_MAX;  // when the byte in the shifter is out
+static uint8_t shifting;
+static bool waiting = false;             // DATA holds a byte for the shifter
+static uint8_t waiting_byte;
+// DRE rose inside a register hook, where the DMAC cannot run; it takes the request next step.
+static bool request_pending = false;
+
+uint32_t host_uart_get_bytes(void) {
+    return bytes_sent;
+}
+
+bool host_uart_busy(void) {
+    return frame_end != UINT64_MAX;
+}
+
+static bool transmitter_enabled(void) {
+    return (USART.CTRLA.reg & SERCOM_USART_CTRLA_ENABLE) && (USART.CTRLB.reg & SERCOM_USART_CTRLB_TXEN);
+}
+
+bool host_uart_data_empty(void) {
+    return transmitter_enabled() && !waiting;
+}
+
+uint64_t host_uart_next_event(void) {
+    return request_pending ? host_sim_get_cycles() : frame_end;
+}
+
+static uint64_t frame_cycles(void) {
+    // Arithmetic BAUD with 16x oversampling: f = f_ref / 16 * (1 - BAUD / 65536).
+    uint64_t remainder = 65536 - USART.BAUD.reg;
+
+    if (!remainder) remainder = 1;
+    return HOST_UART_FRAME_BITS * 16ull * 65536 / remainder;
+}
+
+static void update_interrupt(void) {
+    if (USART.INTFLAG.reg & USART.INTENSET.reg) NVIC->ISPR[0] |= 1ul << SERCOM3_IRQn;
+}
+
+static void emit(uint8_t byte) {
+    if (output == NULL) {
+        const char *path = getenv("WATCH_HOST_UART");
+        output = path ? fopen(path, "wb") : stdout;
+        if (output == NULL) {
+            perror("host: WATCH_HOST_UART");
+            exit(1);
+        }
+    }
+    fputc(byte, output);
+    if (byte == '\n') fflush(output);
+    bytes_sent++;
+}
+
+static void start_frame(uint8_t byte) {
+    shifting = byte;
+    frame_end = host_sim_get_cycles() + frame_cycles();
+}
+
+void host_uart_update(void) {
+    if (frame_end == host_sim_get_cycles()) {
+        emit(shifting);
+        frame_end = UINT64_MAX;
+        host_registers_unlock();
+        if (waiting) {
+            waiting = false;
+            start_frame(waiting_byte);
+            USART.INTFLAG.reg |= SERCOM_USART_INTFLAG_DRE;
+            request_pending = true;
+        } else {
+            USART.INTFLAG.reg |= SERCOM_USART_INTFLAG_TXC;
+        }
+        update_interrupt();
+        host_registers_lock();
+    }
+    if (request_pending) {
+        request_pending = false;
+        if (host_uart_data_empty()) host_dmac_trigger(HOST_DMAC_TRIGSRC_SERCOM3_TX);
+    }
+}
+
+void host_uart_ctrla_written(uint32_t before, uint32_t written) {
+    if (written & SERCOM_USART_CTRLA_SWRST) {
+        memset((void *)&USART, 0, sizeof(SercomUsart));
+    } else if (written & SERCOM_USART_CTRLA_ENABLE) {
+        if (!(before & SERCOM_USART_CTRLA_ENABLE)) {
+            USART.INTFLAG.reg |= SERCOM_USART_INTFLAG_DRE;
+            update_interrupt();
+        }
+        return;
+    }
+    // Disabling drops the frame in progress and anything waiting.
+    frame_end = UINT64_MAX;
+    waiting = false;
+    request_pending = false;
+    USART.INTFLAG.reg &= ~(SERCOM_USART_INTFLAG_DRE | SERCOM_USART_INTFLAG_TXC);
+}
+
+void host_uart_inten_written(uint32_t before, uint32_t written) {
+    (void)before;
+    (void)written;
+    update_interrupt();
+}
+
+void host_uart_data_written(uint32_t before, uint32_t written) {
+    (void)before;
+    if (!transmitter_enabled()) return;
+
+    USART.INTFLAG.reg &= ~SERCOM_USART_INTFLAG_TXC;
+    if (!host_uart_busy()) {
+        // The shifter takes the byte at once, so DATA is still empty.
+        start_frame(written);
+        request_pending = true;
+    } else if (!waiting) {
+        waiting = true;
+        waiting_byte = written;
+        USART.INTFLAG.reg &= ~SERCOM_USART_INTFLAG_DRE;
+    }
+}
@@ -0,0 +1,39 @@
+/*
+ * SERCOM3 USART transmitter for the host build.
+ *
+ * DATA feeds a shift register, as on the chip: a byte written while the shifter is idle starts
+ * out at once and leaves DRE up, and one written while it is busy waits in DATA with DRE down.
+ * Each frame takes ten bit times at the rate CTRLA's arithmetic BAUD sets from the CPU clock
+ * (SERCOM3 runs from GCLK0). TXC comes up when the shifter empties with nothing waiting. DRE is
+ * also the SERCOM3 TX DMA request, which a DMAC channel takes whenever it rises and when the
+ * channel is enabled while it is up. The receiver is not modeled.
+ *
+ * Sent bytes go to the file named by WATCH_HOST_UART, or to stdout, as each frame ends.
+ */
+#ifndef _HOST_UART_H_
+#define _HOST_UART_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** @brief Returns the number of bytes sent since startup. */
+uint32_t host_uart_get_bytes(void);
+
+/** @brief Returns whether a frame is going out. */
+bool host_uart_busy(void);
+
+/** @brief Returns whether the transmitter is enabled with DATA empty, holding up its DMA request. */
+bool host_uart_data_empty(void);
+
+/** @brief Returns the cycle at which a frame ends or the DMA request is next raised, or UINT64_MAX. */
+uint64_t host_uart_next_event(void);
+
+/** @brief Ends the frame due now and raises the DMA request if it is due. */
+void host_uart_update(void);
+
+// Register write hooks for host_registers.c.
+void host_uart_ctrla_written(uint32_t before, uint32_t written);
+void host_uart_inten_written(uint32_t before, uint32_t written);
+void host_uart_data_written(uint32_t before, uint32_t written);
+
+#endif /* _HOST_UART_H_ */
@@ -0,0 +1,15 @@
+/*
+ * Host build shim for saml22.h.
+ *
+ * The host Makefile target puts this directory ahead of watch-library/include, so every
+ * #include "saml22.h" in the HAL, HPL and watch library lands here. We pull in the real
+ * device header with the CMSIS instruction and function headers replaced by host stubs.
+ * Peripheral macros keep their real bus addresses; host_peripherals.c maps RAM there.
+ */
+#ifndef _SAML22_HOST_
+#define _SAML22_HOST_
+
+#include "host_cmsis.h"
+#include "../include/saml22.h"
+
+#endif /* _SAML22_HOST_ */
@@ -0,0 +1,206 @@
+/*
+ * Checks hal_calendar.c's closed-form timestamp conversions against the year-by-year and
+ * month-by-month loops they replaced, and measures the core cycles each version takes per call.
+ *
+ * The conversions are static, so this includes hal_calendar.c and links without hal_calendar.o.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "../../hal/src/hal_calendar.c"
+#include "host_sim.h"
+
+#define BENCH_CALLS 1000
+
+/// convert_timestamp_to_datetime() as it was before the closed-form version.
+static int32_t old_timestamp_to_datetime(struct calendar_descriptor *const calendar, uint32_t ts,
+                                         struct calendar_date_time *dt) {
+    uint32_t tmp, sec_in_year, sec_in_month;
+    uint32_t tmp_year    = calendar->base_year;
+    uint8_t  tmp_month   = 1;
+    uint8_t  tmp_day     = 1;
+    uint8_t  tmp_hour    = 0;
+    uint8_t  tmp_minutes = 0;
+
+    tmp = ts;
+
+    while (true) {
+        sec_in_year = leap_year(tmp_year) ? SECS_IN_LEAP_YEAR : SECS_IN_NON_LEAP_YEAR;
+        if (tmp >= sec_in_year) {
+            tmp -= sec_in_year;
+            tmp_year++;
+        } else {
+            break;
+        }
+    }
+    while (true) {
+        sec_in_month = get_secs_in_month(tmp_year, tmp_month);
+        if (tmp >= sec_in_month) {
+            tmp -= sec_in_month;
+            tmp_month++;
+        } else {
+            break;
+        }
+    }
+    while (tmp >= SECS_IN_DAY) {
+        tmp -= SECS_IN_DAY;
+        tmp_day++;
+    }
+    while (tmp >= SECS_IN_HOUR) {
+        tmp -= SECS_IN_HOUR;
+        tmp_hour++;
+    }
+    while (tmp >= SECS_IN_MINUTE) {
+        tmp -= SECS_IN_MINUTE;
+        tmp_minutes++;
+    }
+
+    dt->date.year  = tmp_year;
+    dt->date.month = tmp_month;
+    dt->date.day   = tmp_day;
+    dt->time.hour  = tmp_hour;
+    dt->time.min   = tmp_minutes;
+    dt->time.sec   = tmp;
+
+    return ERR_NONE;
+}
+
+/// convert_datetime_to_timestamp() as it was before the closed-form version.
+static uint32_t old_datetime_to_timestamp(struct calendar_descriptor *const calendar, struct calendar_date_time *dt) {
+    uint32_t tmp = 0;
+    uint32_t i   = 0;
+    uint8_t  year, month, day, hour, minutes, seconds;
+
+    year    = dt->date.year - calendar->base_year;
+    month   = dt->date.month;
+    day     = dt->date.day;
+    hour    = dt->time.hour;
+    minutes = dt->time.min;
+    seconds = dt->time.sec;
+
+    for (i = 0; i < year; ++i) {
+        if (leap_year(calendar->base_year + i)) {
+            tmp += SECS_IN_LEAP_YEAR;
+        } else {
+            tmp += SECS_IN_NON_LEAP_YEAR;
+        }
+    }
+    for (i = 1; i < month; ++i) {
+        tmp += get_secs_in_month(dt->date.year, i);
+    }
+    tmp += (day - 1) * SECS_IN_DAY;
+    tmp += hour * SECS_IN_HOUR;
+    tmp += minutes * SECS_IN_MINUTE;
+    tmp += seconds;
+
+    return tmp;
+}
+
+static bool same_datetime(const struct calendar_date_time *a, const struct calendar_date_time *b) {
+    return a->date.year == b->date.year && a->date.month == b->date.month && a->date.day == b->date.day &&
+           a->time.hour == b->time.hour && a->time.min == b->time.min && a->time.sec == b->time.sec;
+}
+
+/// Every day of the 32-bit range, at the start, end and a few points in between, plus the last second.
+static int check_timestamp_to_datetime(struct calendar_descriptor *calendar) {
+    static const uint32_t times[] = { 0, 1, 59, 3599, 43200, 86399 };
+    struct calendar_date_time old_dt, new_dt;
+    int failures = 0;
+
+    for (uint64_t day = 0; day * SECS_IN_DAY <= UINT32_MAX; day++) {
+        for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++) {
+            uint64_t ts = day * SECS_IN_DAY + times[i];
+            if (ts > UINT32_MAX) ts = UINT32_MAX;
+
+            old_timestamp_to_datetime(calendar, ts, &old_dt);
+            convert_timestamp_to_datetime(calendar, ts, &new_dt);
+            if (!same_datetime(&old_dt, &new_dt)) {
+                if (failures++ < 10) {
+                    fprintf(stderr, "calendar: base %lu, timestamp %llu converts to %u-%u-%u, was %u-%u-%u\n",
+                            (unsigned long)calendar->base_year, (unsigned long long)ts, new_dt.date.year,
+                            new_dt.date.month, new_dt.date.day, old_dt.date.year, old_dt.date.month, old_dt.date.day);
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+/// Every year the eight-bit offset can reach and a few before the base, every month and day field
+/// value up to one past the valid range, and the smallest and largest time fields.
+static int check_datetime_to_timestamp(struct calendar_descriptor *calendar) {
+    static const uint8_t hours[] = { 0, 23, 24, 255 };
+    static const uint8_t minutes[] = { 0, 59, 60, 255 };
+    struct calendar_date_time dt;
+    int failures = 0;
+    uint32_t first_year = calendar->base_year >= 4 ? calendar->base_year - 4 : 0;
+
+    memset(&dt, 0, sizeof(dt));
+    for (uint32_t year = first_year; year <= calendar->base_year + 259; year++) {
+        for (uint32_t month = 0; month <= 14; month++) {
+            for (uint32_t day = 0; day <= 32; day++) {
+                for (size_t i = 0; i < sizeof(hours) / sizeof(hours[0]); i++) {
+                    dt.date.year  = year;
+                    dt.date.month = month;
+                    dt.date.day   = day;
+                    dt.time.hour  = hours[i];
+                    dt.time.min   = minutes[i];
+                    dt.time.sec   = minutes[i];
+
+                    uint32_t old_ts = old_datetime_to_timestamp(calendar, &dt);
+                    uint32_t new_ts = convert_datetime_to_timestamp(calendar, &dt);
+                    if (old_ts != new_ts && failures++ < 10) {
+                        fprintf(stderr, "calendar: base %lu, %u-%u-%u %u:%u:%u converts to %lu, was %lu\n",
+                                (unsigned long)calendar->base_year, dt.date.year, dt.date.month, dt.date.day,
+                                dt.time.hour, dt.time.min, dt.time.sec, (unsigned long)new_ts,
+                                (unsigned long)old_ts);
+                    }
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+/// Returns the core cycles per call of each direction of conversion for a 2021 date, in that order.
+static void bench(int32_t (*to_datetime)(struct calendar_descriptor *const, uint32_t, struct calendar_date_time *),
+                  uint32_t (*to_timestamp)(struct calendar_descriptor *const, struct calendar_date_time *),
+                  uint64_t cycles[2]) {
+    struct calendar_descriptor calendar = { .base_year = DEFAULT_BASE_YEAR };
+    struct calendar_date_time dt;
+    // 2021-10-18 12:34:56.
+    volatile uint32_t ts = 1634560496;
+    uint64_t start;
+
+    host_sim_sync();
+    start = host_sim_get_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++) to_datetime(&calendar, ts, &dt);
+    host_sim_sync();
+    cycles[0] = (host_sim_get_cycles() - start) / BENCH_CALLS;
+
+    start = host_sim_get_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++) ts = to_timestamp(&calendar, &dt);
+    host_sim_sync();
+    cycles[1] = (host_sim_get_cycles() - start) / BENCH_CALLS;
+}
+
+int main(void) {
+    static const uint32_t base_years[] = { 0, 1970, 1971, 1972, 1973, 2000, 2020, 2021, 65000 };
+    int failures = 0;
+
+    // Measured first: the checks below run far more firmware than a simulated run may charge.
+    uint64_t old_cycles[2], new_cycles[2];
+    bench(old_timestamp_to_datetime, old_datetime_to_timestamp, old_cycles);
+    bench(convert_timestamp_to_datetime, convert_datetime_to_timestamp, new_cycles);
+    printf("calendar: timestamp to date/time, %llu cycles per call before, %llu after\n",
+           (unsigned long long)old_cycles[0], (unsigned long long)new_cycles[0]);
+    printf("calendar: date/time to timestamp, %llu cycles per call before, %llu after\n",
+           (unsigned long long)old_cycles[1], (unsigned long long)new_cycles[1]);
+
+    for (size_t i = 0; i < sizeof(base_years) / sizeof(base_years[0]); i++) {
+        struct calendar_descriptor calendar = { .base_year = base_years[i] };
+        failures += check_timestamp_to_datetime(&calendar);
+        failures += check_datetime_to_timestamp(&calendar);
+    }
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * Checks watch_display_character() against the segment-map walk it replaced, for every position
+ * and character, and measures the core cycles each version takes per watch_display_string() call.
+ *
+ * Both versions are built with the firmware's block counting, so the cycle figures follow the same
+ * model as the simulator's active time (WATCH_HOST_BLOCK_CYCLES per basic block).
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "watch.h"
+#include "hpl_slcd_config.h"
+#include "host_sim.h"
+
+#define DISPLAY_NUM_WORDS ((CONF_SLCD_COM_NUM + 1) * 2)
+#define BENCH_CALLS 1000
+
+/// The character set and segment map watch.c used before utils/segment_masks.py generated masks.
+static const uint8_t Old_Character_Set[] =
+{
+    0b00000000, //
+    0b00000000, // !
+    0b00100010, // "
+    0b00000000, // #
+    0b00000000, // $
+    0b00000000, // %
+    0b01000100, // &
+    0b00100000, // '
+    0b00000000, // (
+    0b00000000, // )
+    0b00000000, // *
+    0b11000000, // +
+    0b00010000, // ,
+    0b01000000, // -
+    0b00000100, // .
+    0b00010010, // /
+    0b00111111, // 0
+    0b00000110, // 1
+    0b01011011, // 2
+    0b01001111, // 3
+    0b01100110, // 4
+    0b01101101, // 5
+    0b01111101, // 6
+    0b00000111, // 7
+    0b01111111, // 8
+    0b01101111, // 9
+    0b00000000, // :
+    0b00000000, // ;
+    0b01011000, // <
+    0b01001000, // =
+    0b01001100, // >
+    0b01010011, // ?
+    0b11111111, // @
+    0b01110111, // A
+    0b01111111, // B
+    0b00111001, // C
+    0b00111111, // D
+    0b01111001, // E
+    0b01110001, // F
+    0b00111101, // G
+    0b01110110, // H
+    0b10001001, // I
+    0b00001110, // J
+    0b11101010, // K
+    0b00111000, // L
+    0b10110111, // M
+    0b00110111, // N
+    0b00111111, // O
+    0b01110011, // P
+    0b01100111, // Q
+    0b11110111, // R
+    0b01101101, // S
+    0b10000001, // T
+    0b00111110, // U
+    0b00111110, // V
+    0b10111110, // W
+    0b01111110, // X
+    0b01101110, // Y
+    0b00011011, // Z
+    0b00111001, // [
+    0b00100100, // backslash
+    0b00001111, // ]
+    0b00100110, // ^
+    0b00001000, // _
+    0b00000010, // `
+    0b01011111, // a
+    0b01111100, // b
+    0b01011000, // c
+    0b01011110, // d
+    0b01111011, // e
+    0b01110001, // f
+    0b01101111, // g
+    0b01110100, // h
+    0b00010000, // i
+    0b01000010, // j
+    0b11101010, // k
+    0b00110000, // l
+    0b10110111, // m
+    0b01010100, // n
+    0b01011100, // o
+    0b01110011, // p
+    0b01100111, // q
+    0b01010000, // r
+    0b01101101, // s
+    0b01111000, // t
+    0b01100010, // u
+    0b01100010, // v
+    0b10111110, // w
+    0b01111110, // x
+    0b01101110, // y
+    0b00011011, // z
+    0b00111001, // {
+    0b00110000, // |
+    0b00001111, // }
+    0b00000001, // ~
+};
+
+static const uint64_t Old_Segment_Map[] = {
+    0x4e4f0e8e8f8d4d0d, // Position 8
+    0xc8c4c4c8b4b4b0b,  // Position 9
+    0xc049c00a49890949, // Position 6
+    0xc048088886874707, // Position 7
+    0xc053921252139352, // Position 0
+    0xc054511415559594, // Position 1
+    0xc057965616179716, // Position 2
+    0xc041804000018a81, // Position 3
+    0xc043420203048382, // Position 4
+    0xc045440506468584, // Position 5
+};
+
+static const uint8_t Num_Chars = 10;
+
+static uint32_t Old_Shadow[DISPLAY_NUM_WORDS];
+static uint16_t Old_Dirty;
+
+static void old_set_segment(uint8_t com, uint8_t seg, bool on) {
+    if (com > CONF_SLCD_COM_NUM || seg >= CONF_SLCD_SEG_NUM) return;
+
+    uint8_t word = com * 2 + (seg >> 5);
+    uint32_t mask = 1ul << (seg & 0x1F);
+    uint32_t value = on ? (Old_Shadow[word] | mask) : (Old_Shadow[word] & ~mask);
+
+    if (value == Old_Shadow[word]) return;
+    Old_Shadow[word] = value;
+    Old_Dirty |= 1 << word;
+}
+
+static void old_display_character(uint8_t character, uint8_t position) {
+    if (position >= Num_Chars) return;
+
+    uint64_t segmap = Old_Segment_Map[position];
+    uint64_t segdata = Old_Character_Set[character - 0x20];
+
+    for (int i = 0; i < 8; i++) {
+        uint8_t com = (segmap & 0xFF) >> 6;
+        if (com > 2) {
+            // COM3 means no segment exists; skip it.
+            segmap = segmap >> 8;
+            segdata = segdata >> 1;
+            continue;
+        }
+        uint8_t seg = segmap & 0x3F;
+        old_set_segment(com, seg, segdata & 1);
+        segmap = segmap >> 8;
+        segdata = segdata >> 1;
+    }
+}
+
+static void old_display_string(char *string, uint8_t position) {
+    size_t i = 0;
+    while(string[i] != 0) {
+        old_display_character(string[i], position + i);
+        i++;
+        if (i >= Num_Chars) break;
+    }
+}
+
+/// Lights or clears every segment in both versions, and commits the new one so SDATA matches.
+static void fill(bool on) {
+    for (uint8_t com = 0; com <= CONF_SLCD_COM_NUM; com++) {
+        for (uint8_t seg = 0; seg < CONF_SLCD_SEG_NUM; seg++) {
+            if (on) watch_display_pixel(com, seg);
+            else watch_clear_pixel(com, seg);
+            old_set_segment(com, seg, on);
+        }
+    }
+    watch_display_commit();
+}
+
+static bool matches(void) {
+    const volatile uint32_t *sdata = (const volatile uint32_t *)&SLCD->SDATAL0.reg;
+    for (uint8_t word = 0; word < DISPLAY_NUM_WORDS; word++) {
+        if (sdata[word] != Old_Shadow[word]) return false;
+    }
+    return true;
+}
+
+/// Returns the core cycles per call of display_string() over BENCH_CALLS calls, alternating
+/// between two strings so that every call changes segments.
+static uint64_t bench(void (*display_string)(char *, uint8_t)) {
+    char first[] = "MO10123456";
+    char second[] = "TU11235959";
+
+    host_sim_sync();
+    uint64_t start = host_sim_get_cycles();
+    for (int i = 0; i < BENCH_CALLS; i++) {
+        display_string(i & 1 ? second : first, 0);
+    }
+    host_sim_sync();
+    return (host_sim_get_cycles() - start) / BENCH_CALLS;
+}
+
+int main(void) {
+    int failures = 0;
+
+    watch_enable_display();
+    for (int on = 0; on <= 1; on++) {
+        for (uint8_t position = 0; position < Num_Chars; position++) {
+            for (uint8_t character = ' '; character <= '~'; character++) {
+                fill(on);
+                old_display_character(character, position);
+                watch_display_character(character, position);
+                watch_display_commit();
+                if (!matches()) {
+                    fprintf(stderr, "display: '%c' at position %u over %s segments differs\n",
+                            character, position, on ? "lit" : "clear");
+                    failures++;
+                }
+            }
+        }
+    }
+
+    uint64_t old_cycles = bench(old_display_string);
+    uint64_t new_cycles = bench(watch_display_string);
+    printf("display: watch_display_string of 10 characters, %llu cycles per call before, %llu after\n",
+           (unsigned long long)old_cycles, (unsigned long long)new_cycles);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+/*
+ * Measures the EIC interrupt latency, in core cycles from entering the handler to entering the
+ * button's callback, of the flat EXTINT table against the two binary searches it replaced.
+ *
+ * Both handlers are called directly with the same INTFLAG and INTENSET, and both are built with
+ * the firmware's block counting, so the figures follow the simulator's active time model.
+ */
+#include <stdio.h>
+#include <string.h>
+#include "watch.h"
+#include "hpl_eic_config.h"
+#include "host_registers.h"
+#include "host_sim.h"
+
+#define OLD_EXT_IRQ_AMOUNT 3
+#define INVALID_PIN_NUMBER 0xFFFFFFFF
+
+static const uint32_t button_pins[OLD_EXT_IRQ_AMOUNT] = { BTN_ALARM, BTN_LIGHT, BTN_MODE };
+static const uint8_t button_extints[OLD_EXT_IRQ_AMOUNT] = { 5, 6, 7 };
+
+static uint64_t handler_start;
+static uint64_t arrived[OLD_EXT_IRQ_AMOUNT];
+
+static void arrive(uint8_t button) {
+    host_sim_sync();
+    arrived[button] = host_sim_get_cycles() - handler_start;
+}
+
+static void alarm_callback(void) { arrive(0); }
+static void light_callback(void) { arrive(1); }
+static void mode_callback(void) { arrive(2); }
+
+static const ext_irq_cb_t callbacks[OLD_EXT_IRQ_AMOUNT] = { alarm_callback, light_callback, mode_callback };
+
+/// hal_ext_irq.c's callback table before the flat EXTINT table, as ext_irq_register() left it
+/// with the three buttons registered: sorted by pin.
+struct old_ext_irq {
+    ext_irq_cb_t cb;
+    uint32_t     pin;
+};
+
+static struct old_ext_irq old_ext_irqs[OLD_EXT_IRQ_AMOUNT] = {
+    { light_callback, BTN_LIGHT },
+    { mode_callback, BTN_MODE },
+    { alarm_callback, BTN_ALARM },
+};
+
+struct old_eic_map {
+    uint8_t  extint;
+    uint32_t pin;
+};
+
+static const struct old_eic_map old_map[] = {CONFIG_EIC_EXTINT_MAP};
+
+static void old_process_ext_irq(const uint32_t pin) {
+    uint8_t lower = 0, middle, upper = OLD_EXT_IRQ_AMOUNT;
+
+    while (upper >= lower) {
+        middle = (upper + lower) >> 1;
+        if (middle >= OLD_EXT_IRQ_AMOUNT) {
+            return;
+        }
+
+        if (old_ext_irqs[middle].pin == pin) {
+            if (old_ext_irqs[middle].cb) {
+                old_ext_irqs[middle].cb();
+            }
+            return;
+        }
+
+        if (old_ext_irqs[middle].pin < pin) {
+            lower = middle + 1;
+        } else {
+            upper = middle - 1;
+        }
+    }
+}
+
+/// hpl_eic.c's _ext_irq_handler before the flat EXTINT table.
+static void old_ext_irq_handler(void) {
+    volatile uint32_t flags = hri_eic_read_INTFLAG_reg(EIC);
+    int8_t            pos;
+    uint32_t          pin = INVALID_PIN_NUMBER;
+
+    hri_eic_clear_INTFLAG_reg(EIC, flags);
+
+    while (flags) {
+        pos = ffs(flags) - 1;
+        while (-1 != pos) {
+            uint8_t lower = 0, middle, upper = OLD_EXT_IRQ_AMOUNT;
+
+            while (upper >= lower) {
+                middle = (upper + lower) >> 1;
+                if (old_map[middle].extint == pos) {
+                    pin = old_map[middle].pin;
+                    break;
+                }
+                if (old_map[middle].extint < pos) {
+                    lower = middle + 1;
+                } else {
+                    upper = middle - 1;
+                }
+            }
+
+            if (INVALID_PIN_NUMBER != pin) {
+                old_process_ext_irq(pin);
+            }
+            flags &= ~(1ul << pos);
+            pos = ffs(flags) - 1;
+        }
+        flags = hri_eic_read_INTFLAG_reg(EIC);
+        hri_eic_clear_INTFLAG_reg(EIC, flags);
+    }
+}
+
+/// EIC_Handler, which calls the HPL's handler as it does now.
+static void old_eic_handler(void) {
+    old_ext_irq_handler();
+}
+
+/// Raises the given buttons' EXTINT flags, runs the handler, and returns the cycles until the
+/// last of their callbacks was entered, or 0 if one of them was not called.
+static uint64_t latency(void (*handler)(void), uint8_t buttons) {
+    uint64_t last = 0;
+
+    host_registers_unlock();
+    for (uint8_t i = 0; i < OLD_EXT_IRQ_AMOUNT; i++) {
+        arrived[i] = 0;
+        if (buttons & (1 << i)) EIC->INTFLAG.reg |= 1ul << button_extints[i];
+    }
+    host_registers_lock();
+
+    host_sim_sync();
+    handler_start = host_sim_get_cycles();
+    handler();
+
+    for (uint8_t i = 0; i < OLD_EXT_IRQ_AMOUNT; i++) {
+        if (!(buttons & (1 << i))) continue;
+        if (!arrived[i]) return 0;
+        if (arrived[i] > last) last = arrived[i];
+    }
+    return last;
+}
+
+int main(void) {
+    static const char *names[OLD_EXT_IRQ_AMOUNT] = { "ALARM", "LIGHT", "MODE" };
+    int failures = 0;
+
+    EXTERNAL_IRQ_0_init();
+    for (uint8_t i = 0; i < OLD_EXT_IRQ_AMOUNT; i++) ext_irq_register(button_pins[i], callbacks[i]);
+
+    for (uint8_t buttons = 1; buttons < 1 << OLD_EXT_IRQ_AMOUNT; buttons++) {
+        // A single button, or all three at once; two at once falls between them.
+        if (buttons != 7 && (buttons & (buttons - 1))) continue;
+
+        uint64_t old_cycles = latency(old_eic_handler, buttons);
+        uint64_t new_cycles = latency(EIC_Handler, buttons);
+        if (!old_cycles || !new_cycles) {
+            fprintf(stderr, "ext_irq: a callback was not called\n");
+            failures++;
+        }
+        if (buttons == 7) {
+            printf("ext_irq: all three buttons, %llu cycles to the last callback before, %llu after\n",
+                   (unsigned long long)old_cycles, (unsigned long long)new_cycles);
+        } else {
+            uint8_t i = __builtin_ctz(buttons);
+            printf("ext_irq: %s, %llu cycles to its callback before, %llu after\n", names[i],
+                   (unsigned long long)old_cycles, (unsigned long long)new_cycles);
+        }
+    }
+
+    return failures ? 1 : 0;
+}
@@ -157,6 +157,13 @@ int32_t _dma_set_next_descriptor(const uint8_t current_channel, const uint8_t ne
 	return ERR_NONE;
 }
 
+int32_t _dma_set_next_descriptor_address(const uint8_t channel, const void *const descriptor)
+{
+	hri_dmacdescriptor_write_DESCADDR_reg(&_descriptor_section[channel], (uint32_t)descriptor);
+
+	return ERR_NONE;
+}
+
 int32_t _dma_srcinc_enable(const uint8_t channel, const bool enable)
 {
 	hri_dmacdescriptor_write_BTCTRL_SRCINC_bit(&_descriptor_section[channel], enable);
@@ -70,8 +70,6 @@ static int ffs(int v)
 	}
 #endif
 
-#define EXT_IRQ_AMOUNT 3
-
 /**
  * \brief EXTINTx and pin number map
  */
@@ -88,14 +86,14 @@ static const struct _eic_map _map[] = {CONFIG_EIC_EXTINT_MAP};
 /**
  * \brief The callback to upper layer's interrupt processing routine
  */
-static void (*callback)(const uint32_t pin);
+static void (*callback)(const uint8_t extint);
 
 static void _ext_irq_handler(void);
 
 /**
  * \brief Initialize external interrupt module
  */
-int32_t _ext_irq_init(void (*cb)(const uint32_t pin))
+int32_t _ext_irq_init(void (*cb)(const uint8_t extint))
 {
 	if (!hri_eic_is_syncing(EIC, EIC_SYNCBUSY_SWRST)) {
 		if (hri_eic_get_CTRLA_reg(EIC, EIC_CTRLA_ENABLE)) {
@@ -177,20 +175,29 @@ int32_t _ext_irq_deinit(void)
 }
 
 /**
- * \brief Enable / disable external irq
+ * \brief Retrieve the EXTINT line of a pin
  */
-int32_t _ext_irq_enable(const uint32_t pin, const bool enable)
+int32_t _ext_irq_get_extint(const uint32_t pin)
 {
-	uint8_t extint = INVALID_EXTINT_NUMBER;
-	uint8_t i      = 0;
+	uint8_t i = 0;
 
 	for (; i < ARRAY_SIZE(_map); i++) {
 		if (_map[i].pin == pin) {
-			extint = _map[i].extint;
-			break;
+			return _map[i].extint;
 		}
 	}
-	if (INVALID_EXTINT_NUMBER == extint) {
+
+	return -1;
+}
+
+/**
+ * \brief Enable / disable external irq
+ */
+int32_t _ext_irq_enable(const uint32_t pin, const bool enable)
+{
+	int32_t extint = _ext_irq_get_extint(pin);
+
+	if (extint < 0) {
 		return -1;
 	}
 
@@ -209,40 +216,18 @@ int32_t _ext_irq_enable(const uint32_t pin, const bool enable)
  */
 static void _ext_irq_handler(void)
 {
-	volatile uint32_t flags = hri_eic_read_INTFLAG_reg(EIC);
-	int8_t            pos;
-	uint32_t          pin = INVALID_PIN_NUMBER;
-
-	hri_eic_clear_INTFLAG_reg(EIC, flags);
+	/* Masked lines still raise their flags; leave those alone */
+	uint32_t flags = hri_eic_read_INTFLAG_reg(EIC) & hri_eic_read_INTEN_reg(EIC);
 
 	ASSERT(callback);
 
 	while (flags) {
-		pos = ffs(flags) - 1;
-		while (-1 != pos) {
-			uint8_t lower = 0, middle, upper = EXT_IRQ_AMOUNT;
-
-			while (upper >= lower) {
-				middle = (upper + lower) >> 1;
-				if (_map[middle].extint == pos) {
-					pin = _map[middle].pin;
-					break;
-				}
-				if (_map[middle].extint < pos) {
-					lower = middle + 1;
-				} else {
-					upper = middle - 1;
-				}
-			}
-
-			if (INVALID_PIN_NUMBER != pin) {
-				callback(pin);
-			}
-			flags &= ~(1ul << pos);
-			pos = ffs(flags) - 1;
-		}
-		flags = hri_eic_read_INTFLAG_reg(EIC);
 		hri_eic_clear_INTFLAG_reg(EIC, flags);
+		do {
+			callback(ffs(flags) - 1);
+			flags &= flags - 1;
+		} while (flags);
+		flags = hri_eic_read_INTFLAG_reg(EIC) & hri_eic_read_INTEN_reg(EIC);
 	}
 }
 
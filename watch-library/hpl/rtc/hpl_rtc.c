@@ -33,12 +33,78 @@
  */
 
 #include <hpl_calendar.h>
+#include <utils.h>
 #include <utils_assert.h>
 #include <hpl_rtc_config.h>
 
 /*!< Pointer to hpl device */
 static struct calendar_dev *_rtc_dev = NULL;
 
+/* The RTC runs in clock/calendar mode (MODE2), so the hardware keeps the date and time.
+ * The calendar HAL still works with counters in seconds since 1970-01-01; the functions
+ * below convert between those and the CLOCK/ALARM register layout.
+ */
+#define RTC_COUNTER_BASE_YEAR 1970
+#define RTC_SECS_IN_DAY 86400
+/* 1968 is the leap year at or before the counter's base year */
+#define RTC_DAYS_1968_TO_BASE 731
+
+static const uint16_t _rtc_days_before_month[13] = {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334};
+
+/* The first and last second CLOCK can hold: the six-bit YEAR field counts from CONF_RTC_REFERENCE_YEAR */
+#define RTC_CLOCK_FIRST (RTC_MODE2_CLOCK_MONTH(1) | RTC_MODE2_CLOCK_DAY(1))
+#define RTC_CLOCK_LAST                                                                                                 \
+	(RTC_MODE2_CLOCK_YEAR_Msk | RTC_MODE2_CLOCK_MONTH(12) | RTC_MODE2_CLOCK_DAY(31) | RTC_MODE2_CLOCK_HOUR(23)          \
+	 | RTC_MODE2_CLOCK_MINUTE(59) | RTC_MODE2_CLOCK_SECOND(59))
+
+/**
+ * \brief Convert seconds since 1970 to the CLOCK/ALARM register layout
+ */
+static uint32_t _rtc_clock_from_counter(const uint32_t counter)
+{
+	uint32_t days = counter / RTC_SECS_IN_DAY + RTC_DAYS_1968_TO_BASE;
+	uint32_t secs = counter % RTC_SECS_IN_DAY;
+	uint32_t year = 1968 + days / 1461 * 4;
+	uint32_t day  = days % 1461;
+	uint32_t month;
+
+	if (day >= 366) {
+		year += (day - 1) / 365;
+		day = (day - 1) % 365;
+	}
+	for (month = 12; day < _rtc_days_before_month[month] + ((month > 2 && !(year & 3)) ? 1u : 0u); month--)
+		;
+	day -= _rtc_days_before_month[month] + ((month > 2 && !(year & 3)) ? 1u : 0u);
+
+	return RTC_MODE2_CLOCK_YEAR(year - CONF_RTC_REFERENCE_YEAR) | RTC_MODE2_CLOCK_MONTH(month)
+	       | RTC_MODE2_CLOCK_DAY(day + 1) | RTC_MODE2_CLOCK_HOUR(secs / 3600)
+	       | RTC_MODE2_CLOCK_MINUTE(secs % 3600 / 60) | RTC_MODE2_CLOCK_SECOND(secs % 60);
+}
+
+/**
+ * \brief Convert the CLOCK/ALARM register layout to seconds since 1970
+ */
+static uint32_t _rtc_counter_from_clock(const uint32_t clock)
+{
+	uint32_t year  = CONF_RTC_REFERENCE_YEAR + ((clock & RTC_MODE2_CLOCK_YEAR_Msk) >> RTC_MODE2_CLOCK_YEAR_Pos);
+	uint32_t month = (clock & RTC_MODE2_CLOCK_MONTH_Msk) >> RTC_MODE2_CLOCK_MONTH_Pos;
+	uint32_t day   = (clock & RTC_MODE2_CLOCK_DAY_Msk) >> RTC_MODE2_CLOCK_DAY_Pos;
+	uint32_t days;
+
+	if (month < 1 || month > 12) {
+		month = 1;
+	}
+	days = (year - 1968) * 365 + (year - 1968 + 3) / 4 + _rtc_days_before_month[month] + day - 1;
+	if (month > 2 && !(year & 3)) {
+		days++;
+	}
+
+	return (days - RTC_DAYS_1968_TO_BASE) * RTC_SECS_IN_DAY
+	       + ((clock & RTC_MODE2_CLOCK_HOUR_Msk) >> RTC_MODE2_CLOCK_HOUR_Pos) * 3600
+	       + ((clock & RTC_MODE2_CLOCK_MINUTE_Msk) >> RTC_MODE2_CLOCK_MINUTE_Pos) * 60
+	       + ((clock & RTC_MODE2_CLOCK_SECOND_Msk) >> RTC_MODE2_CLOCK_SECOND_Pos);
+}
+
 /**
  * \brief Initializes the RTC module with given configurations.
  */
@@ -48,28 +114,34 @@ int32_t _calendar_init(struct calendar_dev *const dev)
 
 	_rtc_dev = dev;
 
-	if (hri_rtcmode0_get_CTRLA_ENABLE_bit(dev->hw)) {
+	if (hri_rtcmode2_get_CTRLA_ENABLE_bit(dev->hw)) {
 #if !CONF_RTC_INIT_RESET
-		return ERR_DENIED;
-#else
-		hri_rtcmode0_clear_CTRLA_ENABLE_bit(dev->hw);
-		hri_rtcmode0_wait_for_sync(dev->hw, RTC_MODE0_SYNCBUSY_ENABLE);
+		/* Keep the time, unless the RTC was left counting in another mode. */
+		if (hri_rtcmode2_read_CTRLA_MODE_bf(dev->hw) == RTC_MODE2_CTRLA_MODE_CLOCK_Val) {
+			return ERR_DENIED;
+		}
 #endif
+		hri_rtcmode2_clear_CTRLA_ENABLE_bit(dev->hw);
+		hri_rtcmode2_wait_for_sync(dev->hw, RTC_MODE2_SYNCBUSY_ENABLE);
 	}
-	hri_rtcmode0_set_CTRLA_SWRST_bit(dev->hw);
-	hri_rtcmode0_wait_for_sync(dev->hw, RTC_MODE0_SYNCBUSY_SWRST);
+	hri_rtcmode2_set_CTRLA_SWRST_bit(dev->hw);
+	hri_rtcmode2_wait_for_sync(dev->hw, RTC_MODE2_SYNCBUSY_SWRST);
 
 #if CONF_RTC_EVENT_CONTROL_ENABLE == 1
-	hri_rtcmode0_write_EVCTRL_reg(
+	hri_rtcmode2_write_EVCTRL_reg(
 	    dev->hw,
-	    (CONF_RTC_PEREO0 << RTC_MODE0_EVCTRL_PEREO0_Pos) | (CONF_RTC_PEREO1 << RTC_MODE0_EVCTRL_PEREO1_Pos)
-	        | (CONF_RTC_PEREO2 << RTC_MODE0_EVCTRL_PEREO2_Pos) | (CONF_RTC_PEREO3 << RTC_MODE0_EVCTRL_PEREO3_Pos)
-	        | (CONF_RTC_PEREO4 << RTC_MODE0_EVCTRL_PEREO4_Pos) | (CONF_RTC_PEREO5 << RTC_MODE0_EVCTRL_PEREO5_Pos)
-	        | (CONF_RTC_PEREO6 << RTC_MODE0_EVCTRL_PEREO6_Pos) | (CONF_RTC_PEREO7 << RTC_MODE0_EVCTRL_PEREO7_Pos)
-	        | (CONF_RTC_COMPE0 << RTC_MODE0_EVCTRL_CMPEO_Pos) | (CONF_RTC_OVFEO << RTC_MODE0_EVCTRL_OVFEO_Pos));
+	    (CONF_RTC_PEREO0 << RTC_MODE2_EVCTRL_PEREO0_Pos) | (CONF_RTC_PEREO1 << RTC_MODE2_EVCTRL_PEREO1_Pos)
+	        | (CONF_RTC_PEREO2 << RTC_MODE2_EVCTRL_PEREO2_Pos) | (CONF_RTC_PEREO3 << RTC_MODE2_EVCTRL_PEREO3_Pos)
+	        | (CONF_RTC_PEREO4 << RTC_MODE2_EVCTRL_PEREO4_Pos) | (CONF_RTC_PEREO5 << RTC_MODE2_EVCTRL_PEREO5_Pos)
+	        | (CONF_RTC_PEREO6 << RTC_MODE2_EVCTRL_PEREO6_Pos) | (CONF_RTC_PEREO7 << RTC_MODE2_EVCTRL_PEREO7_Pos)
+	        | (CONF_RTC_COMPE0 << RTC_MODE2_EVCTRL_ALARMEO0_Pos) | (CONF_RTC_OVFEO << RTC_MODE2_EVCTRL_OVFEO_Pos));
 #endif
 
-	hri_rtcmode0_write_CTRLA_reg(dev->hw, RTC_MODE0_CTRLA_PRESCALER(CONF_RTC_PRESCALER) | RTC_MODE0_CTRLA_COUNTSYNC);
+	hri_rtcmode2_write_CTRLA_reg(dev->hw,
+	                             RTC_MODE2_CTRLA_PRESCALER(CONF_RTC_PRESCALER) | RTC_MODE2_CTRLA_MODE_CLOCK
+	                                 | RTC_MODE2_CTRLA_CLOCKSYNC);
+	/* CLOCK resets to zero, which is not a valid date. */
+	hri_rtcmode2_write_CLOCK_reg(dev->hw, RTC_CLOCK_FIRST);
 
 	hri_rtc_write_TAMPCTRL_reg(
 	    dev->hw,
@@ -86,7 +158,7 @@ int32_t _calendar_init(struct calendar_dev *const dev)
 	if ((CONF_RTC_TAMPER_INACT_0 == TAMPER_MODE_ACTL) | (CONF_RTC_TAMPER_INACT_1 == TAMPER_MODE_ACTL)
 	    | (CONF_RTC_TAMPER_INACT_2 == TAMPER_MODE_ACTL) | (CONF_RTC_TAMPER_INACT_3 == TAMPER_MODE_ACTL)
 	    | (CONF_RTC_TAMPER_INACT_4 == TAMPER_MODE_ACTL)) {
-		hri_rtcmode0_set_CTRLB_RTCOUT_bit(dev->hw);
+		hri_rtcmode2_set_CTRLB_RTCOUT_bit(dev->hw);
 	}
 	return ERR_NONE;
 }
@@ -101,8 +173,8 @@ int32_t _calendar_deinit(struct calendar_dev *const dev)
 	NVIC_DisableIRQ(RTC_IRQn);
 	dev->callback = NULL;
 
-	hri_rtcmode0_clear_CTRLA_ENABLE_bit(dev->hw);
-	hri_rtcmode0_set_CTRLA_SWRST_bit(dev->hw);
+	hri_rtcmode2_clear_CTRLA_ENABLE_bit(dev->hw);
+	hri_rtcmode2_set_CTRLA_SWRST_bit(dev->hw);
 
 	return ERR_NONE;
 }
@@ -114,7 +186,7 @@ int32_t _calendar_enable(struct calendar_dev *const dev)
 {
 	ASSERT(dev && dev->hw);
 
-	hri_rtcmode0_set_CTRLA_ENABLE_bit(dev->hw);
+	hri_rtcmode2_set_CTRLA_ENABLE_bit(dev->hw);
 
 	return ERR_NONE;
 }
@@ -126,7 +198,7 @@ int32_t _calendar_disable(struct calendar_dev *const dev)
 {
 	ASSERT(dev && dev->hw);
 
-	hri_rtcmode0_clear_CTRLA_ENABLE_bit(dev->hw);
+	hri_rtcmode2_clear_CTRLA_ENABLE_bit(dev->hw);
 
 	return ERR_NONE;
 }
@@ -138,11 +210,23 @@ int32_t _calendar_set_counter(struct calendar_dev *const dev, const uint32_t cou
 {
 	ASSERT(dev && dev->hw);
 
-	hri_rtcmode0_write_COUNT_reg(dev->hw, counter);
+	if (counter < _rtc_counter_from_clock(RTC_CLOCK_FIRST) || counter > _rtc_counter_from_clock(RTC_CLOCK_LAST)) {
+		return ERR_INVALID_ARG;
+	}
+	hri_rtcmode2_write_CLOCK_reg(dev->hw, _rtc_clock_from_counter(counter));
+	_calendar_counter_written(dev);
 
 	return ERR_NONE;
 }
 
+/**
+ * \brief Default for platforms that keep no copy of the time
+ */
+WEAK void _calendar_counter_written(struct calendar_dev *const dev)
+{
+	(void)dev;
+}
+
 /**
  * \brief Get current counter
  */
@@ -150,17 +234,28 @@ uint32_t _calendar_get_counter(struct calendar_dev *const dev)
 {
 	ASSERT(dev && dev->hw);
 
-	return hri_rtcmode0_read_COUNT_reg(dev->hw);
+	return _rtc_counter_from_clock(hri_rtcmode2_read_CLOCK_reg(dev->hw));
 }
 
 /**
  * \brief Set the compare for the specified value.
  */
-int32_t _calendar_set_comp(struct calendar_dev *const dev, const uint32_t comp)
+int32_t _calendar_set_comp(struct calendar_dev *const dev, const uint32_t comp, const enum calendar_alarm_option option)
 {
-	ASSERT(dev && dev->hw);
+	uint32_t first, last;
 
-	hri_rtcmode0_write_COMP_reg(dev->hw, 0, comp);
+	ASSERT(dev && dev->hw);
+	ASSERT(option >= CALENDAR_ALARM_MATCH_SEC && option <= CALENDAR_ALARM_MATCH_YEAR);
+
+	/* A compare outside what CLOCK can hold waits at its nearest end; the HAL checks the time
+	 * again when the alarm fires.
+	 */
+	first = _rtc_counter_from_clock(RTC_CLOCK_FIRST);
+	last  = _rtc_counter_from_clock(RTC_CLOCK_LAST);
+	hri_rtcmode2_write_ALARM_reg(
+	    dev->hw, 0, _rtc_clock_from_counter(comp < first ? first : (comp > last ? last : comp)));
+	/* The alarm options line up with MASK.SEL, from SS to YYMMDDHHMMSS. */
+	hri_rtcmode2_write_MASK_reg(dev->hw, 0, RTC_MODE2_MASK_SEL(option));
 
 	return ERR_NONE;
 }
@@ -172,7 +267,7 @@ uint32_t _calendar_get_comp(struct calendar_dev *const dev)
 {
 	ASSERT(dev && dev->hw);
 
-	return hri_rtcmode0_read_COMP_reg(dev->hw, 0);
+	return _rtc_counter_from_clock(hri_rtcmode2_read_ALARM_reg(dev->hw, 0));
 }
 
 /**
@@ -311,17 +406,37 @@ int32_t _tamper_register_callback(struct calendar_dev *const dev, tamper_drv_cb_
 		/* register the callback */
 		dev->callback_tamper = callback_tamper;
 
-		/* enable RTC_IRQn */
+		/* enable RTC_IRQn; _calendar_set_periodic_interrupts() selects the intervals */
 		NVIC_ClearPendingIRQ(RTC_IRQn);
 		NVIC_EnableIRQ(RTC_IRQn);
-
-		/* enable tamper interrupt */
-		hri_rtcmode0_set_INTEN_PER7_bit(dev->hw);
 	} else {
-		/* disable tamper interrupt */
-		hri_rtcmode0_clear_INTEN_PER7_bit(dev->hw);
+		/* disable periodic interrupts */
+		hri_rtcmode2_clear_INTEN_reg(dev->hw, RTC_MODE2_INTENSET_PER_Msk);
+
+		/* disable RTC_IRQn once no other RTC interrupt needs it */
+		if (!hri_rtcmode2_read_INTEN_reg(dev->hw)) {
+			NVIC_DisableIRQ(RTC_IRQn);
+		}
+	}
+
+	return ERR_NONE;
+}
+
+int32_t _calendar_set_periodic_interrupts(struct calendar_dev *const dev, const uint8_t periods)
+{
+	ASSERT(dev && dev->hw);
+
+	uint8_t enabled = (hri_rtcmode2_read_INTEN_reg(dev->hw) & RTC_MODE2_INTENSET_PER_Msk) >> RTC_MODE2_INTENSET_PER_Pos;
 
-		/* disable RTC_IRQn */
+	/* flags are raised whether or not the interrupt is enabled, so drop stale ones first */
+	hri_rtcmode2_clear_INTEN_reg(dev->hw, RTC_MODE2_INTENSET_PER(~periods & 0xFF));
+	hri_rtcmode2_clear_INTFLAG_reg(dev->hw, RTC_MODE2_INTFLAG_PER(periods & ~enabled));
+	hri_rtcmode2_set_INTEN_reg(dev->hw, RTC_MODE2_INTENSET_PER(periods));
+
+	/* RTC_IRQn is needed as long as any RTC interrupt is enabled */
+	if (hri_rtcmode2_read_INTEN_reg(dev->hw)) {
+		NVIC_EnableIRQ(RTC_IRQn);
+	} else {
 		NVIC_DisableIRQ(RTC_IRQn);
 	}
 
@@ -343,14 +458,16 @@ int32_t _calendar_register_callback(struct calendar_dev *const dev, calendar_drv
 		NVIC_ClearPendingIRQ(RTC_IRQn);
 		NVIC_EnableIRQ(RTC_IRQn);
 
-		/* enable cmp */
-		hri_rtcmode0_set_INTEN_CMP0_bit(dev->hw);
+		/* enable alarm */
+		hri_rtcmode2_set_INTEN_ALARM0_bit(dev->hw);
 	} else {
-		/* disable cmp */
-		hri_rtcmode0_clear_INTEN_CMP0_bit(dev->hw);
+		/* disable alarm */
+		hri_rtcmode2_clear_INTEN_ALARM0_bit(dev->hw);
 
-		/* disable RTC_IRQn */
-		NVIC_DisableIRQ(RTC_IRQn);
+		/* disable RTC_IRQn once no other RTC interrupt needs it */
+		if (!hri_rtcmode2_read_INTEN_reg(dev->hw)) {
+			NVIC_DisableIRQ(RTC_IRQn);
+		}
 	}
 
 	return ERR_NONE;
@@ -364,19 +481,19 @@ int32_t _calendar_register_callback(struct calendar_dev *const dev, calendar_drv
 static void _rtc_interrupt_handler(struct calendar_dev *dev)
 {
 	/* Read and mask interrupt flag register */
-	uint16_t interrupt_status  = hri_rtcmode0_read_INTFLAG_reg(dev->hw);
-	uint16_t interrupt_enabled = hri_rtcmode0_read_INTEN_reg(dev->hw);
+	uint16_t interrupt_status  = hri_rtcmode2_read_INTFLAG_reg(dev->hw);
+	uint16_t interrupt_enabled = hri_rtcmode2_read_INTEN_reg(dev->hw);
 
 	if ((interrupt_status & interrupt_enabled) & RTC_MODE2_INTFLAG_ALARM0) {
 		dev->callback(dev);
 
 		/* Clear interrupt flag */
-		hri_rtcmode0_clear_interrupt_CMP0_bit(dev->hw);
-	} else if ((interrupt_status & interrupt_enabled) & RTC_MODE2_INTFLAG_PER7) {
+		hri_rtcmode2_clear_interrupt_ALARM0_bit(dev->hw);
+	} else if ((interrupt_status & interrupt_enabled) & RTC_MODE2_INTFLAG_PER_Msk) {
 		dev->callback_tamper(dev);
 
-		/* Clear interrupt flag */
-		hri_rtcmode0_clear_interrupt_PER7_bit(dev->hw);
+		/* Clear interrupt flags */
+		hri_rtcmode2_clear_INTFLAG_reg(dev->hw, interrupt_status & RTC_MODE2_INTFLAG_PER_Msk);
 	}
 }
 /**
@@ -571,11 +571,16 @@ static uint8_t _get_sercom_index(const void *const hw)
 	return 0;
 }
 
+static struct _i2c_m_async_device *_sercom1_dev = NULL;
+
 /**
  * \brief Init irq param with the given sercom hardware instance
  */
 static void _sercom_init_irq_param(const void *const hw, void *dev)
 {
+	if (hw == SERCOM1) {
+		_sercom1_dev = (struct _i2c_m_async_device *)dev;
+	}
 }
 
 /**
@@ -1277,6 +1282,60 @@ int32_t _i2c_m_async_get_bytes_left(struct _i2c_m_async_device *const i2c_dev)
 	return 0;
 }
 
+/**
+ * \internal Sercom i2c master interrupt handler
+ *
+ * The flags are analysed exactly as in polled mode; the handler only reports the end of the
+ * message, or the error that cut it short, through the device callbacks.
+ *
+ * \param[in] i2c_dev The pointer to i2c device
+ */
+static void _sercom_i2c_m_irq_handler(struct _i2c_m_async_device *i2c_dev)
+{
+	void *             hw    = i2c_dev->hw;
+	struct _i2c_m_msg *msg   = &i2c_dev->service.msg;
+	uint32_t           flags = hri_sercomi2cm_read_INTFLAG_reg(hw);
+	int32_t            ret;
+
+	if (flags & ERROR_FLAG) {
+		hri_sercomi2cm_clear_interrupt_ERROR_bit(hw);
+		msg->flags |= I2C_M_FAIL;
+		msg->flags &= ~I2C_M_BUSY;
+
+		if (i2c_dev->cb.error) {
+			i2c_dev->cb.error(i2c_dev, I2C_ERR_BUS);
+		}
+
+		return;
+	}
+
+	ret = _sercom_i2c_sync_analyse_flags(hw, flags, msg);
+
+	if (ret != I2C_OK) {
+		msg->flags &= ~I2C_M_BUSY;
+
+		if (i2c_dev->cb.error) {
+			i2c_dev->cb.error(i2c_dev, ret);
+		}
+	} else if (!(msg->flags & I2C_M_BUSY)) {
+		if (msg->flags & I2C_M_RD) {
+			if (i2c_dev->cb.rx_complete) {
+				i2c_dev->cb.rx_complete(i2c_dev);
+			}
+		} else if (i2c_dev->cb.tx_complete) {
+			i2c_dev->cb.tx_complete(i2c_dev);
+		}
+	}
+}
+
+/**
+ * \internal Sercom interrupt handler
+ */
+void SERCOM1_Handler(void)
+{
+	_sercom_i2c_m_irq_handler(_sercom1_dev);
+}
+
 /**
  * \brief Initialize sercom i2c module to use in sync mode
  *
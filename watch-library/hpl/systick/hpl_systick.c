@@ -85,19 +85,14 @@ system_time_t _system_time_get_max_time_value(const void *const hw)
 void _delay_cycles(void *const hw, uint32_t cycles)
 {
 	(void)hw;
-	uint8_t  n   = cycles >> 24;
-	uint32_t buf = cycles;
+	uint32_t last = SysTick->VAL;
 
-	while (n--) {
-		SysTick->LOAD = 0xFFFFFF;
-		SysTick->VAL  = 0xFFFFFF;
-		while (!(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk))
-			;
-		buf -= 0xFFFFFF;
-	}
+	/* SysTick keeps running from its full 24-bit reload, so others can use it as a clock. */
+	while (cycles) {
+		uint32_t now     = SysTick->VAL;
+		uint32_t elapsed = (last - now) & SysTick_VAL_CURRENT_Msk;
 
-	SysTick->LOAD = buf;
-	SysTick->VAL  = buf;
-	while (!(SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk))
-		;
+		last   = now;
+		cycles = elapsed < cycles ? cycles - elapsed : 0;
+	}
 }
@@ -36,59 +36,29 @@
 #include "saml22.h"
 #include "hal_init.h"
 #include "peripheral_clk_config.h"
-#include "hal_gpio.h"
 #include "atmel_start_pins.h"
 #include "watch.h"
+#include "watch_energy.h"
 #include "app.h"
 
 //-----------------------------------------------------------------------------
-HAL_GPIO_PIN(UART_TX,   B, 0)
-HAL_GPIO_PIN(UART_RX,   B, 2)
-
-//-----------------------------------------------------------------------------
-static void uart_init(uint32_t baud) {
-    uint64_t br = (uint64_t)65536 * (CONF_CPU_FREQUENCY - 16 * baud) / CONF_CPU_FREQUENCY;
-
-    HAL_GPIO_UART_TX_out();
-    HAL_GPIO_UART_TX_pmuxen(HAL_GPIO_PMUX_C);
-    HAL_GPIO_UART_RX_in();
-    HAL_GPIO_UART_RX_pmuxen(HAL_GPIO_PMUX_C);
-
-    MCLK->APBCMASK.reg |= MCLK_APBCMASK_SERCOM3;
-
-    GCLK->PCHCTRL[SERCOM3_GCLK_ID_CORE].reg = GCLK_PCHCTRL_GEN(0) | GCLK_PCHCTRL_CHEN;
-    while (0 == (GCLK->PCHCTRL[SERCOM3_GCLK_ID_CORE].reg & GCLK_PCHCTRL_CHEN));
-
-    SERCOM3->USART.CTRLA.reg =
-        SERCOM_USART_CTRLA_DORD | SERCOM_USART_CTRLA_MODE(1/*USART_INT_CLK*/) |
-        SERCOM_USART_CTRLA_RXPO(0/*PAD0*/) | SERCOM_USART_CTRLA_TXPO(1/*PAD2*/);
-
-    SERCOM3->USART.CTRLB.reg = SERCOM_USART_CTRLB_RXEN | SERCOM_USART_CTRLB_TXEN |
-        SERCOM_USART_CTRLB_CHSIZE(0/*8 bits*/);
-
-    SERCOM3->USART.BAUD.reg = (uint16_t)br;
-
-    SERCOM3->USART.CTRLA.reg |= SERCOM_USART_CTRLA_ENABLE;
-}
-
-//-----------------------------------------------------------------------------
+// Kept for debugging code that calls them; both queue on the watch library's log and never block.
 void uart_putc(char c) {
-    while (!(SERCOM3->USART.INTFLAG.reg & SERCOM_USART_INTFLAG_DRE));
-    SERCOM3->USART.DATA.reg = c;
+    watch_log_write(&c, 1);
 }
 
 //-----------------------------------------------------------------------------
 void uart_puts(char *s) {
-    while (*s) uart_putc(*s++);
+    watch_log_write(s, strlen(s));
 }
 
 int main(void) {
-    // Temporary, for debugging.
-    uart_init(115200);
-
     // ASF code. Initialize the MCU with configuration options from Atmel Studio.
     init_mcu();
 
+    // Temporary, for debugging.
+    watch_enable_log(115200);
+
     // User code. Give the app a chance to initialize its data structures and state.
     app_init();
 
@@ -105,11 +75,28 @@ int main(void) {
     app_setup();
 
     while (1) {
+        watch_event_t event;
+        while (watch_get_event(&event)) {
+            WATCH_ENERGY_ENTER(WATCH_ENERGY_APP_HANDLE_EVENT);
+            app_handle_event(event);
+            WATCH_ENERGY_EXIT(WATCH_ENERGY_APP_HANDLE_EVENT);
+        }
+
+        WATCH_ENERGY_ENTER(WATCH_ENERGY_APP_LOOP);
         bool can_sleep = app_loop();
+        WATCH_ENERGY_EXIT(WATCH_ENERGY_APP_LOOP);
         if (can_sleep) {
+            WATCH_ENERGY_ENTER(WATCH_ENERGY_APP_PREPARE_FOR_SLEEP);
             app_prepare_for_sleep();
-            sleep(4);
+            WATCH_ENERGY_EXIT(WATCH_ENERGY_APP_PREPARE_FOR_SLEEP);
+            // With interrupts masked, an event queued after the drain above still ends WFI at
+            // once; its handler then runs when they are unmasked, and the loop picks it up.
+            __disable_irq();
+            if (!watch_has_pending_events()) sleep(watch_get_sleep_mode());
+            __enable_irq();
+            WATCH_ENERGY_ENTER(WATCH_ENERGY_APP_WAKE_FROM_SLEEP);
             app_wake_from_sleep();
+            WATCH_ENERGY_EXIT(WATCH_ENERGY_APP_WAKE_FROM_SLEEP);
         }
     }
 
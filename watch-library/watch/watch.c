@@ -1,5 +1,14 @@
 #include "watch.h"
+#include <stdarg.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include "hpl_slcd_config.h"
+#include "hpl_rtc_config.h"
+#include "hpl_dma.h"
+#include "hpl_adc_dma.h"
+// Generated from utils/segment_masks.py by the Makefile.
+#include "watch_segment_masks.h"
 
 void watch_init() {
     // Use switching regulator for lower power consumption.
@@ -14,150 +23,56 @@ void watch_init() {
     delay_driver_init();
 }
 
-static const uint8_t Character_Set[] =
-{
-    0b00000000, //  
-    0b00000000, // !
-    0b00100010, // "
-    0b00000000, // #
-    0b00000000, // $
-    0b00000000, // %
-    0b01000100, // &
-    0b00100000, // '
-    0b00000000, // (
-    0b00000000, // )
-    0b00000000, // *
-    0b11000000, // +
-    0b00010000, // ,
-    0b01000000, // -
-    0b00000100, // .
-    0b00010010, // /
-    0b00111111, // 0
-    0b00000110, // 1
-    0b01011011, // 2
-    0b01001111, // 3
-    0b01100110, // 4
-    0b01101101, // 5
-    0b01111101, // 6
-    0b00000111, // 7
-    0b01111111, // 8
-    0b01101111, // 9
-    0b00000000, // :
-    0b00000000, // ;
-    0b01011000, // <
-    0b01001000, // =
-    0b01001100, // >
-    0b01010011, // ?
-    0b11111111, // @
-    0b01110111, // A
-    0b01111111, // B
-    0b00111001, // C
-    0b00111111, // D
-    0b01111001, // E
-    0b01110001, // F
-    0b00111101, // G
-    0b01110110, // H
-    0b10001001, // I
-    0b00001110, // J
-    0b11101010, // K
-    0b00111000, // L
-    0b10110111, // M
-    0b00110111, // N
-    0b00111111, // O
-    0b01110011, // P
-    0b01100111, // Q
-    0b11110111, // R
-    0b01101101, // S
-    0b10000001, // T
-    0b00111110, // U
-    0b00111110, // V
-    0b10111110, // W
-    0b01111110, // X
-    0b01101110, // Y
-    0b00011011, // Z
-    0b00111001, // [
-    0b00100100, // backslash
-    0b00001111, // ]
-    0b00100110, // ^
-    0b00001000, // _
-    0b00000010, // `
-    0b01011111, // a
-    0b01111100, // b
-    0b01011000, // c
-    0b01011110, // d
-    0b01111011, // e
-    0b01110001, // f
-    0b01101111, // g
-    0b01110100, // h
-    0b00010000, // i
-    0b01000010, // j
-    0b11101010, // k
-    0b00110000, // l
-    0b10110111, // m
-    0b01010100, // n
-    0b01011100, // o
-    0b01110011, // p
-    0b01100111, // q
-    0b01010000, // r
-    0b01101101, // s
-    0b01111000, // t
-    0b01100010, // u
-    0b01100010, // v
-    0b10111110, // w
-    0b01111110, // x
-    0b01101110, // y
-    0b00011011, // z
-    0b00111001, // {
-    0b00110000, // |
-    0b00001111, // }
-    0b00000001, // ~
-};
+static const uint8_t Num_Chars = SEGMENT_MASK_NUM_POSITIONS;
 
-static const uint64_t Segment_Map[] = {
-    0x4e4f0e8e8f8d4d0d, // Position 8
-    0xc8c4c4c8b4b4b0b,  // Position 9
-    0xc049c00a49890949, // Position 6
-    0xc048088886874707, // Position 7
-    0xc053921252139352, // Position 0
-    0xc054511415559594, // Position 1
-    0xc057965616179716, // Position 2
-    0xc041804000018a81, // Position 3
-    0xc043420203048382, // Position 4
-    0xc045440506468584, // Position 5
-};
+// RAM copy of SDATAL0/SDATAH0 .. SDATALn/SDATAHn, two words per COM line. Drawing calls only
+// touch this buffer; watch_display_commit() copies the words marked dirty to the SLCD.
+#define DISPLAY_NUM_WORDS ((CONF_SLCD_COM_NUM + 1) * 2)
+static uint32_t Display_Shadow[DISPLAY_NUM_WORDS];
+static uint16_t Display_Dirty = 0;
 
-static const uint8_t Num_Chars = 10;
+static void _watch_display_set_segment(uint8_t com, uint8_t seg, bool on) {
+    if (com > CONF_SLCD_COM_NUM || seg >= CONF_SLCD_SEG_NUM) return;
+
+    uint8_t word = com * 2 + (seg >> 5);
+    uint32_t mask = 1ul << (seg & 0x1F);
+    uint32_t value = on ? (Display_Shadow[word] | mask) : (Display_Shadow[word] & ~mask);
+
+    if (value == Display_Shadow[word]) return;
+    Display_Shadow[word] = value;
+    Display_Dirty |= 1 << word;
+}
 
 void watch_enable_display() {
     SEGMENT_LCD_0_init();
     slcd_sync_enable(&SEGMENT_LCD_0);
+    // SEGMENT_LCD_0_init cleared the segment memory.
+    memset(Display_Shadow, 0, sizeof(Display_Shadow));
+    Display_Dirty = 0;
 }
 
 void watch_display_pixel(uint8_t com, uint8_t seg) {
-    slcd_sync_seg_on(&SEGMENT_LCD_0, SLCD_SEGID(com, seg));
+    _watch_display_set_segment(com, seg, true);
 }
 
 void watch_clear_pixel(uint8_t com, uint8_t seg) {
-    slcd_sync_seg_off(&SEGMENT_LCD_0, SLCD_SEGID(com, seg));
+    _watch_display_set_segment(com, seg, false);
 }
 
 void watch_display_character(uint8_t character, uint8_t position) {
-    uint64_t segmap = Segment_Map[position];
-    uint64_t segdata = Character_Set[character - 0x20];
-
-    for (int i = 0; i < 8; i++) {
-        uint8_t com = (segmap & 0xFF) >> 6;
-        if (com > 2) {
-            // COM3 means no segment exists; skip it.
-            segmap = segmap >> 8;
-            segdata = segdata >> 1;
-            continue;
-        }
-        uint8_t seg = segmap & 0x3F;
-        slcd_sync_seg_off(&SEGMENT_LCD_0, SLCD_SEGID(com, seg));
-        if (segdata & 1) slcd_sync_seg_on(&SEGMENT_LCD_0, SLCD_SEGID(com, seg));
-        segmap = segmap >> 8;
-        segdata = segdata >> 1;
+    if (position >= Num_Chars) return;
+    if (character < 0x20 || character - 0x20 >= SEGMENT_MASK_NUM_CHARACTERS) character = ' ';
+
+    const uint32_t *clear = Position_Masks[position];
+    const uint32_t *set = Character_Masks[position][character - 0x20];
+
+    for (uint8_t i = 0; i < SEGMENT_MASK_NUM_WORDS; i++) {
+        uint8_t word = Segment_Mask_Words[i];
+        uint32_t value = (Display_Shadow[word] & ~clear[i]) | set[i];
+
+        if (value == Display_Shadow[word]) continue;
+        Display_Shadow[word] = value;
+        Display_Dirty |= 1 << word;
     }
 }
 
@@ -170,23 +85,67 @@ void watch_display_string(char *string, uint8_t position) {
     }
 }
 
-void watch_enable_buttons() {
-    EXTERNAL_IRQ_0_init();
+void watch_display_commit() {
+    if (!Display_Dirty) return;
+
+    // With LOCK set the SLCD keeps showing the previous frame, so the new words appear together.
+    hri_slcd_set_CTRLC_LOCK_bit(SLCD);
+    volatile uint32_t *sdata = (volatile uint32_t *)&SLCD->SDATAL0.reg;
+    for (uint8_t word = 0; word < DISPLAY_NUM_WORDS; word++) {
+        if (Display_Dirty & (1 << word)) sdata[word] = Display_Shadow[word];
+    }
+    hri_slcd_clear_CTRLC_LOCK_bit(SLCD);
+    Display_Dirty = 0;
 }
 
-void watch_register_button_callback(const uint32_t pin, ext_irq_cb_t callback) {
-    ext_irq_register(pin, callback);
+// Event queue. Every producer runs in an interrupt handler, and those all share the default
+// priority, so they never preempt one another; the main loop is the only consumer. With one
+// writer per index, the queue needs no critical section. When it is full, new events are dropped.
+#define WATCH_EVENT_QUEUE_SIZE 16
+static watch_event_t event_queue[WATCH_EVENT_QUEUE_SIZE];
+static volatile uint8_t event_head = 0;
+static volatile uint8_t event_tail = 0;
+
+static void _watch_post_event(watch_event_t event) {
+    uint8_t head = event_head;
+
+    if ((uint8_t)(head - event_tail) == WATCH_EVENT_QUEUE_SIZE) return;
+    event_queue[head % WATCH_EVENT_QUEUE_SIZE] = event;
+    // The event has to be in memory before the consumer can see the new head.
+    __DMB();
+    event_head = head + 1;
+}
+
+bool watch_get_event(watch_event_t *event) {
+    uint8_t tail = event_tail;
+
+    if (tail == event_head) return false;
+    __DMB();
+    *event = event_queue[tail % WATCH_EVENT_QUEUE_SIZE];
+    __DMB();
+    event_tail = tail + 1;
+    return true;
+}
+
+bool watch_has_pending_events() {
+    return event_tail != event_head;
 }
 
 bool PWM_0_enabled = false;
+static bool led_effect_active = false;  // TC3 is set up for watch_led_play(), not for PWM_0
+static void _watch_led_end_effect(void);
+
+static void _watch_led_start_pwm(void) {
+    PWM_0_init();
+    pwm_set_parameters(&PWM_0, 10000, 0);
+    pwm_enable(&PWM_0);
+}
 
 void watch_enable_led(bool pwm) {
     if (pwm) {
         if (PWM_0_enabled) return;
 
-        PWM_0_init();
-        pwm_set_parameters(&PWM_0, 10000, 0);
-        pwm_enable(&PWM_0);
+        _watch_led_start_pwm();
 
         PWM_0_enabled = true;
     } else {
@@ -199,6 +158,7 @@ void watch_enable_led(bool pwm) {
 void watch_disable_led(bool pwm) {
     if (pwm) {
         if (!PWM_0_enabled) return;
+        if (led_effect_active) _watch_led_end_effect();
         pwm_disable(&PWM_0);
         PWM_0_enabled = false;
     }
@@ -209,6 +169,10 @@ void watch_disable_led(bool pwm) {
 
 void watch_set_led_color(uint16_t red, uint16_t green) {
     if (PWM_0_enabled) {
+        if (led_effect_active) {
+            _watch_led_end_effect();
+            _watch_led_start_pwm();
+        }
         TC3->COUNT16.CC[0].reg = red;
         TC3->COUNT16.CC[1].reg = green;
     }
@@ -251,35 +215,1006 @@ void watch_set_led_off() {
 }
 
 bool watch_rtc_is_enabled() {
-    return RTC->MODE0.CTRLA.bit.ENABLE;
+    return RTC->MODE2.CTRLA.bit.ENABLE;
 }
 
-void watch_set_date_time(struct calendar_date_time date_time) {
-    calendar_set_date(&CALENDAR_0, &date_time.date);
-    calendar_set_time(&CALENDAR_0, &date_time.time);
+static ext_irq_cb_t tick_user_callback;
+static watch_tick_rate_t tick_rate = WATCH_TICK_1_HZ;
+static struct calendar_alarm tick_minute_alarm;
+
+// At 1 Hz and faster, PER7 stays enabled alongside the tick's own interval to mark each second.
+static bool _watch_tick_counts_seconds(void) {
+    return tick_user_callback != NULL && tick_rate >= WATCH_TICK_1_HZ;
+}
+
+// While the tick runs at 1 Hz or faster, tick_callback keeps a copy of the date and time and
+// brings it up to date on every PER7 interrupt. PER7 comes half a second after CLOCK.SECOND
+// changes, so reads check the copy against the second in CLOCK too; a copy one second behind
+// is advanced by a few increments, and anything else is reseeded from CLOCK. The copy is dropped
+// at startup (including after a wake from BACKUP), whenever the tick rate changes, and on every
+// counter write, whether from watch_set_date_time() or through _calendar_set_counter().
+static struct calendar_date_time cached_date_time;
+static bool cached_date_time_valid = false;
+
+// The RTC counts every year divisible by four as a leap year.
+static uint8_t _watch_month_length(uint16_t year, uint8_t month) {
+    static const uint8_t days_in_month[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+    return days_in_month[month - 1] + (month == 2 && !(year & 3));
+}
+
+static void _watch_advance_date_time(struct calendar_date_time *date_time) {
+    if (++date_time->time.sec < 60) return;
+    date_time->time.sec = 0;
+    if (++date_time->time.min < 60) return;
+    date_time->time.min = 0;
+    if (++date_time->time.hour < 24) return;
+    date_time->time.hour = 0;
+
+    if (++date_time->date.day <= _watch_month_length(date_time->date.year, date_time->date.month)) return;
+    date_time->date.day = 1;
+    if (++date_time->date.month <= 12) return;
+    date_time->date.month = 1;
+    date_time->date.year++;
+}
+
+// The RTC runs in clock/calendar mode, so date and time are bitfields of a single register.
+static void _watch_unpack_clock(RTC_MODE2_CLOCK_Type clock, struct calendar_date_time *date_time) {
+    date_time->date.year = clock.bit.YEAR + CONF_RTC_REFERENCE_YEAR;
+    date_time->date.month = clock.bit.MONTH;
+    date_time->date.day = clock.bit.DAY;
+    date_time->time.hour = clock.bit.HOUR;
+    date_time->time.min = clock.bit.MINUTE;
+    date_time->time.sec = clock.bit.SECOND;
+}
+
+// PER7 runs every second while the copy is valid, so it is never more than a second behind.
+static void _watch_sync_date_time(RTC_MODE2_CLOCK_Type clock) {
+    if (cached_date_time_valid && cached_date_time.time.sec == clock.bit.SECOND) return;
+
+    if (cached_date_time_valid && (cached_date_time.time.sec + 1) % 60 == clock.bit.SECOND) {
+        _watch_advance_date_time(&cached_date_time);
+    } else {
+        _watch_unpack_clock(clock, &cached_date_time);
+        cached_date_time_valid = true;
+    }
+}
+
+void _calendar_counter_written(struct calendar_dev *const dev) {
+    (void)dev;
+    cached_date_time_valid = false;
+}
+
+int32_t watch_set_date_time(struct calendar_date_time date_time) {
+    RTC_MODE2_CLOCK_Type clock;
+
+    // YEAR is six bits, so anything out of range would wrap into some other valid date.
+    if (date_time.date.year < CONF_RTC_REFERENCE_YEAR ||
+        date_time.date.year > CONF_RTC_REFERENCE_YEAR + (RTC_MODE2_CLOCK_YEAR_Msk >> RTC_MODE2_CLOCK_YEAR_Pos) ||
+        date_time.date.month < 1 || date_time.date.month > 12 || date_time.date.day < 1 ||
+        date_time.date.day > _watch_month_length(date_time.date.year, date_time.date.month) ||
+        date_time.time.hour > 23 || date_time.time.min > 59 || date_time.time.sec > 59) {
+        return ERR_INVALID_ARG;
+    }
+
+    clock.reg = 0;
+    clock.bit.YEAR = date_time.date.year - CONF_RTC_REFERENCE_YEAR;
+    clock.bit.MONTH = date_time.date.month;
+    clock.bit.DAY = date_time.date.day;
+    clock.bit.HOUR = date_time.time.hour;
+    clock.bit.MINUTE = date_time.time.min;
+    clock.bit.SECOND = date_time.time.sec;
+
+    hri_rtcmode2_write_CLOCK_reg(RTC, clock.reg);
+    cached_date_time_valid = false;
+
+    return ERR_NONE;
 }
 
 void watch_get_date_time(struct calendar_date_time *date_time) {
-    calendar_get_date_time(&CALENDAR_0, date_time);
+    RTC_MODE2_CLOCK_Type clock;
+
+    CRITICAL_SECTION_ENTER();
+    clock.reg = hri_rtcmode2_read_CLOCK_reg(RTC);
+    if (_watch_tick_counts_seconds()) {
+        _watch_sync_date_time(clock);
+        *date_time = cached_date_time;
+    } else {
+        _watch_unpack_clock(clock, date_time);
+    }
+    CRITICAL_SECTION_LEAVE();
 }
 
-static ext_irq_cb_t tick_user_callback;
+// Timebase. TC0 and TC1 are chained into one 32-bit counter of GCLK3's 32.768 kHz, which runs
+// through STANDBY and wraps only every 36 hours. It runs while anything holds it, from zero when
+// the first holder starts it, and its compare channels wake the core for them: CC0 ends sleeping
+// delays, and CC1 times button gestures. Nothing enables its overflow interrupt. Reading COUNT takes a READSYNC, which waits out
+// several of its clocks, about 150 us, with the core awake.
+#define WATCH_TIMEBASE_HZ 32768
+#define WATCH_TIMEBASE_DELAY 0x01
+#define WATCH_TIMEBASE_TIMESTAMPS 0x02
+#define WATCH_TIMEBASE_BUTTONS 0x04
+
+static uint8_t timebase_holders = 0;
+
+// Returns true if this started the counter, which then reads zero.
+static bool _watch_timebase_hold(uint8_t holder) {
+    bool start = !timebase_holders;
+
+    timebase_holders |= holder;
+    if (!start) return false;
+
+    hri_mclk_set_APBCMASK_TC0_bit(MCLK);
+    hri_mclk_set_APBCMASK_TC1_bit(MCLK);
+    // TC1 shares TC0's peripheral channel.
+    hri_gclk_write_PCHCTRL_reg(GCLK, TC0_GCLK_ID, GCLK_PCHCTRL_GEN_GCLK3 | GCLK_PCHCTRL_CHEN);
+    hri_tc_write_CTRLA_reg(TC0, TC_CTRLA_SWRST);
+    hri_tc_write_CTRLA_reg(TC0, TC_CTRLA_MODE_COUNT32 | TC_CTRLA_RUNSTDBY);
+    NVIC_ClearPendingIRQ(TC0_IRQn);
+    NVIC_EnableIRQ(TC0_IRQn);
+    hri_tc_set_CTRLA_ENABLE_bit(TC0);
+    return true;
+}
+
+static void _watch_timebase_release(uint8_t holder) {
+    timebase_holders &= ~holder;
+    if (timebase_holders) return;
+    hri_tc_clear_CTRLA_ENABLE_bit(TC0);
+    NVIC_DisableIRQ(TC0_IRQn);
+}
+
+static uint32_t _watch_timebase_read(void) {
+    hri_tc_set_CTRLB_CMD_bf(TC0, TC_CTRLBSET_CMD_READSYNC_Val);
+    while (hri_tc_read_CTRLB_CMD_bf(TC0));
+    return hri_tccount32_read_COUNT_reg(TC0);
+}
+
+// Raises MCx, and wakes the core, when the count reaches at.
+static void _watch_timebase_arm(uint8_t channel, uint32_t at) {
+    hri_tccount32_write_CC_reg(TC0, channel, at);
+    hri_tc_clear_INTFLAG_reg(TC0, TC_INTFLAG_MC0 << channel);
+    hri_tc_set_INTEN_reg(TC0, TC_INTENSET_MC0 << channel);
+}
+
+static void _watch_timebase_disarm(uint8_t channel) {
+    hri_tc_clear_INTEN_reg(TC0, TC_INTENSET_MC0 << channel);
+    hri_tc_clear_INTFLAG_reg(TC0, TC_INTFLAG_MC0 << channel);
+}
+
+// Scheduled wakes. Jobs are kept in an unordered list; every wake runs all jobs whose window has
+// opened, and the next wake is set for the earliest window close. While the tick marks seconds
+// the scheduler rides on it instead of programming an RTC alarm of its own.
+static watch_wake_job_t *wake_jobs = NULL;
+static struct calendar_alarm wake_alarm;
+static bool wake_alarm_set = false;
+
+static void _watch_wake_dispatch(void);
+
+static void _watch_wake_alarm_callback(struct calendar_descriptor *const calendar) {
+    (void)calendar;
+    wake_alarm_set = false;
+    _watch_wake_dispatch();
+}
+
+static void _watch_wake_reschedule(void) {
+    watch_wake_job_t *job;
+    uint32_t now, next;
+
+    if (wake_jobs == NULL || _watch_tick_counts_seconds()) {
+        if (wake_alarm_set) calendar_set_alarm_at(&CALENDAR_0, &wake_alarm, 0, NULL);
+        wake_alarm_set = false;
+        return;
+    }
+
+    now = _calendar_get_counter(&CALENDAR_0.device);
+    next = wake_jobs->latest;
+    for (job = wake_jobs->next; job != NULL; job = job->next) {
+        if ((int32_t)(job->latest - next) < 0) next = job->latest;
+    }
+    if ((int32_t)(next - now) <= 0) next = now + 1;
+    calendar_set_alarm_at(&CALENDAR_0, &wake_alarm, next, _watch_wake_alarm_callback);
+    wake_alarm_set = true;
+}
+
+static void _watch_wake_dispatch(void) {
+    uint32_t now = _calendar_get_counter(&CALENDAR_0.device);
+    watch_wake_job_t **link = &wake_jobs;
+
+    while (*link != NULL) {
+        watch_wake_job_t *job = *link;
+        if ((int32_t)(job->earliest - now) > 0) {
+            link = &job->next;
+            continue;
+        }
+        if (job->period) {
+            uint32_t tolerance = job->latest - job->earliest;
+            job->earliest += job->period;
+            // If we fell more than a period behind, restart the schedule from now.
+            if ((int32_t)(job->earliest + tolerance - now) <= 0) job->earliest = now + job->period;
+            job->latest = job->earliest + tolerance;
+            link = &job->next;
+        } else {
+            *link = job->next;
+        }
+        if (job->callback) job->callback();
+        else _watch_post_event((watch_event_t){ .type = WATCH_EVENT_WAKE, .job = job });
+    }
+    _watch_wake_reschedule();
+}
+
+void watch_schedule_wake(watch_wake_job_t *job, uint32_t delay, uint32_t tolerance, uint32_t period, watch_wake_cb_t callback) {
+    watch_wake_job_t *it;
+
+    CRITICAL_SECTION_ENTER();
+    for (it = wake_jobs; it != NULL && it != job; it = it->next);
+    if (it == NULL) {
+        job->next = wake_jobs;
+        wake_jobs = job;
+    }
+    job->earliest = _calendar_get_counter(&CALENDAR_0.device) + delay;
+    job->latest = job->earliest + tolerance;
+    job->period = period;
+    job->callback = callback;
+    _watch_wake_reschedule();
+    CRITICAL_SECTION_LEAVE();
+}
+
+void watch_cancel_wake(watch_wake_job_t *job) {
+    watch_wake_job_t **link;
+
+    CRITICAL_SECTION_ENTER();
+    for (link = &wake_jobs; *link != NULL; link = &(*link)->next) {
+        if (*link == job) {
+            *link = job->next;
+            break;
+        }
+    }
+    _watch_wake_reschedule();
+    CRITICAL_SECTION_LEAVE();
+}
+
+static void _watch_update_periodic_interrupts(void) {
+    uint8_t periods = 0;
+
+    if (_watch_tick_counts_seconds()) {
+        periods = RTC_MODE2_INTENSET_PER7 | RTC_MODE2_INTENSET_PER(1 << (WATCH_TICK_128_HZ - tick_rate));
+    }
+    _calendar_set_periodic_interrupts(&CALENDAR_0.device, periods);
+}
+
+// Buttons. The EIC senses both edges, and its majority filter rejects glitches shorter than a
+// couple of 32 kHz clock periods, but contacts bounce for milliseconds on both press and release.
+// So each accepted edge masks the button's EXTINT interrupt for WATCH_DEBOUNCE_MS; the bounces
+// never wake the core. At the end of that window the pin is read once, and a change the mask
+// hid is taken as the next edge.
+//
+// Gestures are timed from the edges on the timebase: long press and repeat from the press,
+// double tap from the release. Every button's next deadline (end of debounce, long press, repeat
+// or the close of the double-tap window) shares the timebase's CC1, armed for the earliest of
+// them, so the core sleeps between edges and deadlines and nothing polls. Once every button is
+// idle the buttons let go of the timebase.
+#define WATCH_BUTTON_CHANNEL 1
+#define WATCH_BUTTON_TICKS(ms) ((uint32_t)((ms) * WATCH_TIMEBASE_HZ / 1000))
+// CC1 is written about 150 us after the count it is set from is read.
+#define WATCH_BUTTON_MIN_TICKS 8
+
+#define WATCH_DEBOUNCE_MS 30
+
+// Gesture timing, in milliseconds.
+#ifndef WATCH_LONG_PRESS_MS
+#define WATCH_LONG_PRESS_MS 750
+#endif
+#ifndef WATCH_REPEAT_MS
+#define WATCH_REPEAT_MS 190
+#endif
+#ifndef WATCH_DOUBLE_TAP_MS
+#define WATCH_DOUBLE_TAP_MS 300
+#endif
+
+typedef struct {
+    uint32_t pin;
+    uint8_t extint;
+    uint8_t mask;
+    ext_irq_cb_t callback;      // NULL to post events instead
+    bool down;                  // as of the last accepted edge
+    bool settling;              // masked until settle_end
+    bool holding;               // a long press or repeat is due at hold_at
+    bool long_pressed;          // this press has posted LONG_PRESS
+    bool tap_open;              // a press before tap_end counts as a double tap
+    bool double_tapped;         // this press was the second tap, so it cannot start another
+    uint32_t settle_end;
+    uint32_t hold_at;
+    uint32_t tap_end;
+} watch_button_t;
+
+static watch_button_t Buttons[] = {
+    { .pin = BTN_LIGHT, .extint = 6, .mask = WATCH_BUTTON_LIGHT },
+    { .pin = BTN_MODE, .extint = 7, .mask = WATCH_BUTTON_MODE },
+    { .pin = BTN_ALARM, .extint = 5, .mask = WATCH_BUTTON_ALARM },
+};
+#define WATCH_NUM_BUTTONS (sizeof(Buttons) / sizeof(Buttons[0]))
+
+static uint8_t _watch_buttons_down(void) {
+    uint8_t mask = 0;
+
+    for (uint8_t i = 0; i < WATCH_NUM_BUTTONS; i++) {
+        if (Buttons[i].down) mask |= Buttons[i].mask;
+    }
+    return mask;
+}
+
+static void _watch_post_button_event(uint8_t type, watch_button_t *button) {
+    _watch_post_event((watch_event_t){ .type = type, .button = button->pin, .buttons = _watch_buttons_down() });
+}
+
+// Whether the deadline has come by now, on the wrapping 32-bit count.
+static bool _watch_button_due(uint32_t deadline, uint32_t now) {
+    return (int32_t)(now - deadline) >= 0;
+}
+
+// Takes an edge to level at now, and masks the button until it settles.
+static void _watch_button_edge(watch_button_t *button, bool level, uint32_t now) {
+    hri_eic_clear_INTEN_reg(EIC, 1 << button->extint);
+    button->down = level;
+    button->settling = true;
+    button->settle_end = now + WATCH_BUTTON_TICKS(WATCH_DEBOUNCE_MS);
+
+    if (level) {
+        bool double_tap = button->tap_open;
+
+        button->tap_open = false;
+        button->double_tapped = double_tap;
+        button->long_pressed = false;
+        if (button->callback) {
+            button->callback();
+            return;
+        }
+        button->holding = true;
+        button->hold_at = now + WATCH_BUTTON_TICKS(WATCH_LONG_PRESS_MS);
+        _watch_post_button_event(WATCH_EVENT_BUTTON, button);
+        if (double_tap) _watch_post_button_event(WATCH_EVENT_DOUBLE_TAP, button);
+        if (_watch_buttons_down() != button->mask) _watch_post_button_event(WATCH_EVENT_CHORD, button);
+    } else {
+        button->holding = false;
+        // Callbacks only hear about presses.
+        if (button->callback) return;
+        _watch_post_button_event(WATCH_EVENT_BUTTON_UP, button);
+        if (!button->long_pressed && !button->double_tapped) {
+            button->tap_open = true;
+            button->tap_end = now + WATCH_BUTTON_TICKS(WATCH_DOUBLE_TAP_MS);
+        }
+    }
+}
+
+// Arms CC1 for the earliest deadline of any button, or lets go of the timebase if there is none.
+static void _watch_buttons_rearm(uint32_t now) {
+    uint32_t next = 0;
+    bool pending = false;
+
+    for (uint8_t i = 0; i < WATCH_NUM_BUTTONS; i++) {
+        watch_button_t *button = &Buttons[i];
+        uint32_t deadlines[3] = { button->settle_end, button->hold_at, button->tap_end };
+        bool active[3] = { button->settling, button->holding, button->tap_open };
+
+        for (uint8_t j = 0; j < 3; j++) {
+            if (!active[j]) continue;
+            if (!pending || (int32_t)(deadlines[j] - next) < 0) next = deadlines[j];
+            pending = true;
+        }
+    }
+
+    if (!pending) {
+        _watch_timebase_disarm(WATCH_BUTTON_CHANNEL);
+        _watch_timebase_release(WATCH_TIMEBASE_BUTTONS);
+        return;
+    }
+    if ((int32_t)(next - now) < WATCH_BUTTON_MIN_TICKS) next = now + WATCH_BUTTON_MIN_TICKS;
+    _watch_timebase_arm(WATCH_BUTTON_CHANNEL, next);
+}
+
+static void _watch_button_pressed(watch_button_t *button) {
+    uint32_t now = _watch_timebase_hold(WATCH_TIMEBASE_BUTTONS) ? 0 : _watch_timebase_read();
+    bool level = gpio_get_pin_level(button->pin);
+
+    // Anything the filter let through is a real edge, so a level back where the last edge left
+    // it means the button went and came back before the core woke: take both edges.
+    if (level == button->down) _watch_button_edge(button, !level, now);
+    _watch_button_edge(button, level, now);
+    _watch_buttons_rearm(now);
+}
+
+static void _watch_light_pressed() { _watch_button_pressed(&Buttons[0]); }
+static void _watch_mode_pressed() { _watch_button_pressed(&Buttons[1]); }
+static void _watch_alarm_pressed() { _watch_button_pressed(&Buttons[2]); }
+static const ext_irq_cb_t Button_Handlers[WATCH_NUM_BUTTONS] = {
+    _watch_light_pressed, _watch_mode_pressed, _watch_alarm_pressed
+};
+
+// CC1 has matched; runs every deadline that has come.
+static void _watch_buttons_timeout(void) {
+    uint32_t now = _watch_timebase_read();
+
+    for (uint8_t i = 0; i < WATCH_NUM_BUTTONS; i++) {
+        watch_button_t *button = &Buttons[i];
+
+        if (button->settling && _watch_button_due(button->settle_end, now)) {
+            bool level = gpio_get_pin_level(button->pin);
+
+            button->settling = false;
+            if (level == button->down) {
+                // Bounces raised the flag while the interrupt was masked. An edge from here on
+                // pends the interrupt; one before the second read is taken here instead, and the
+                // mask that sets keeps the handler from seeing it.
+                hri_eic_clear_INTFLAG_reg(EIC, 1 << button->extint);
+                hri_eic_set_INTEN_reg(EIC, 1 << button->extint);
+                level = gpio_get_pin_level(button->pin);
+            }
+            if (level != button->down) _watch_button_edge(button, level, now);
+        }
+        if (button->holding && _watch_button_due(button->hold_at, now)) {
+            _watch_post_button_event(button->long_pressed ? WATCH_EVENT_REPEAT : WATCH_EVENT_LONG_PRESS, button);
+            button->long_pressed = true;
+            button->hold_at += WATCH_BUTTON_TICKS(WATCH_REPEAT_MS);
+            // After a long wait to be served, repeat from now rather than catch up.
+            if (_watch_button_due(button->hold_at, now)) button->hold_at = now + WATCH_BUTTON_TICKS(WATCH_REPEAT_MS);
+        }
+        if (button->tap_open && _watch_button_due(button->tap_end, now)) button->tap_open = false;
+    }
+    _watch_buttons_rearm(now);
+}
+
+static void _watch_register_button(const uint32_t pin, ext_irq_cb_t callback, bool post_event) {
+    for (uint8_t i = 0; i < WATCH_NUM_BUTTONS; i++) {
+        if (Buttons[i].pin != pin) continue;
+        Buttons[i].callback = callback;
+        ext_irq_register(pin, (callback || post_event) ? Button_Handlers[i] : NULL);
+        return;
+    }
+    ext_irq_register(pin, callback);
+}
+
+void watch_enable_buttons() {
+    EXTERNAL_IRQ_0_init();
+}
+
+void watch_register_button_callback(const uint32_t pin, ext_irq_cb_t callback) {
+    _watch_register_button(pin, callback, false);
+}
+
+void watch_register_button_event(const uint32_t pin) {
+    _watch_register_button(pin, NULL, true);
+}
 
 static void tick_callback(struct calendar_dev *const dev) {
+    // This runs before the RTC handler clears INTFLAG, so the flags say which intervals elapsed.
+    // Intervals nobody enabled raise their flags too; those are cleared and otherwise ignored.
+    uint8_t flags = hri_rtcmode2_read_INTFLAG_reg(dev->hw) & RTC_MODE2_INTFLAG_PER_Msk;
+    uint8_t periods = flags & hri_rtcmode2_read_INTEN_reg(dev->hw);
+
+    hri_rtcmode2_clear_INTFLAG_reg(dev->hw, flags);
+    if (!_watch_tick_counts_seconds()) return;
+
+    if (periods & RTC_MODE2_INTFLAG_PER7) {
+        _watch_sync_date_time((RTC_MODE2_CLOCK_Type){ .reg = hri_rtcmode2_read_CLOCK_reg(dev->hw) });
+        if (wake_jobs != NULL) _watch_wake_dispatch();
+    }
+    if (periods & RTC_MODE2_INTFLAG_PER(1 << (WATCH_TICK_128_HZ - tick_rate))) tick_user_callback();
+}
+
+static void _watch_tick_minute_callback(struct calendar_descriptor *const calendar) {
+    uint32_t now = _calendar_get_counter(&calendar->device);
+
+    calendar_set_alarm_at(calendar, &tick_minute_alarm, now - now % 60 + 60, _watch_tick_minute_callback);
     tick_user_callback();
 }
 
+static void _watch_apply_tick_rate(void) {
+    _watch_update_periodic_interrupts();
+
+    if (tick_user_callback != NULL && tick_rate == WATCH_TICK_PER_MINUTE) {
+        uint32_t now = _calendar_get_counter(&CALENDAR_0.device);
+        calendar_set_alarm_at(&CALENDAR_0, &tick_minute_alarm, now - now % 60 + 60, _watch_tick_minute_callback);
+    } else {
+        calendar_set_alarm_at(&CALENDAR_0, &tick_minute_alarm, 0, NULL);
+    }
+
+    // Below 1 Hz nothing advances the cached date and time, so reads go to the RTC.
+    cached_date_time_valid = false;
+    _watch_wake_reschedule();
+}
+
 void watch_enable_tick_callback(ext_irq_cb_t callback) {
+    CRITICAL_SECTION_ENTER();
     tick_user_callback = callback;
-    // TODO: rename this method to reflect that it now sets the PER7 interrupt.
+    // TODO: rename this method to reflect that it registers the periodic interrupt callback.
     _tamper_register_callback(&CALENDAR_0.device, &tick_callback);
+    _watch_apply_tick_rate();
+    CRITICAL_SECTION_LEAVE();
+}
+
+static void _watch_tick_event() {
+    _watch_post_event((watch_event_t){ .type = WATCH_EVENT_TICK });
+}
+
+void watch_enable_tick_events() {
+    watch_enable_tick_callback(_watch_tick_event);
+}
+
+void watch_set_tick_rate(watch_tick_rate_t rate) {
+    CRITICAL_SECTION_ENTER();
+    tick_rate = rate;
+    _watch_apply_tick_rate();
+    CRITICAL_SECTION_LEAVE();
+}
+
+// DMA. Each channel belongs to one peripheral and keeps the trigger, beat size and address
+// increments set for it in hpl_dmac_config.h; only the addresses and count change per transfer.
+#define WATCH_DMA_CHANNEL_I2C_RX 0  // SERCOM1 RX trigger, DATA to memory
+#define WATCH_DMA_CHANNEL_I2C_TX 1  // SERCOM1 TX trigger, memory to DATA
+#define WATCH_DMA_CHANNEL_ADC 2     // ADC RESRDY trigger, RESULT to memory
+#define WATCH_DMA_CHANNEL_LOG 3     // SERCOM3 TX trigger, memory to DATA
+#define WATCH_DMA_CHANNEL_LED 4     // TC3 OVF trigger, memory to CC
+#define WATCH_DMA_CHANNEL_NONE 0xFF
+
+static bool dma_enabled = false;
+
+static void _watch_enable_dma(void) {
+    if (dma_enabled) return;
+    hri_mclk_set_AHBMASK_DMAC_bit(MCLK);
+    _dma_init();
+    dma_enabled = true;
+}
+
+static void _watch_dma_disable_channel(uint8_t channel) {
+    uint8_t current = hri_dmac_read_CHID_reg(DMAC);
+
+    hri_dmac_write_CHID_reg(DMAC, channel);
+    hri_dmac_clear_CHCTRLA_ENABLE_bit(DMAC);
+    hri_dmac_write_CHID_reg(DMAC, current);
+}
+
+// LED effects. Each keyframe becomes one DMA block: a hold is a single frame sent over and over
+// with the source address fixed, and a fade is a run of frames rendered into led_frames. TC3's
+// overflow triggers one beat per PWM period, a halfword that lands on CC0 (red) and CC1 (green)
+// of the 8-bit counter at once. Only the channel's section descriptor and the final block raise
+// an interrupt; a looping effect links its last block back to a copy of the first, and runs
+// without waking the core at all after its first block.
+#ifndef WATCH_LED_MAX_FRAMES
+#define WATCH_LED_MAX_FRAMES 256
+#endif
+#ifndef WATCH_LED_MAX_KEYFRAMES
+#define WATCH_LED_MAX_KEYFRAMES 8
+#endif
+#define WATCH_LED_CLOCK_HZ 32768    // GCLK3, as PWM_0 is configured
+#define WATCH_LED_PWM_TOP 255       // 128 PWM periods, and so frames, per second
+
+static uint16_t led_frames[WATCH_LED_MAX_FRAMES];  // red in the low byte, green in the high byte
+// The section descriptor plays the first block; these are the rest, with led_descriptors[0] a
+// copy of the first for a loop to come back to.
+COMPILER_ALIGNED(16) static DmacDescriptor led_descriptors[WATCH_LED_MAX_KEYFRAMES];
+static volatile bool led_playing = false;
+static volatile uint8_t led_interrupts_left;  // block interrupts until a one-shot effect is over
+
+static void _watch_led_block(DmacDescriptor *descriptor, const uint16_t *frames, uint16_t length, bool fade) {
+    uint16_t btctrl = DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_HWORD;
+
+    if (fade) btctrl |= DMAC_BTCTRL_SRCINC;
+    hri_dmacdescriptor_write_BTCTRL_reg(descriptor, btctrl);
+    hri_dmacdescriptor_write_BTCNT_reg(descriptor, length);
+    // With SRCINC set the descriptor holds the address just past the block.
+    hri_dmacdescriptor_write_SRCADDR_reg(descriptor, (uint32_t)(fade ? frames + length : frames));
+    hri_dmacdescriptor_write_DSTADDR_reg(descriptor, (uint32_t)&TC3->COUNT8.CC[0].reg);
+    hri_dmacdescriptor_write_DESCADDR_reg(descriptor, 0);
+}
+
+static void _watch_led_done(struct _dma_resource *resource) {
+    (void)resource;
+    if (led_interrupts_left && !--led_interrupts_left) led_playing = false;
+}
+
+static void _watch_led_error(struct _dma_resource *resource) {
+    (void)resource;
+    led_playing = false;
+}
+
+static void _watch_led_end_effect(void) {
+    _watch_dma_disable_channel(WATCH_DMA_CHANNEL_LED);
+    led_playing = false;
+    led_effect_active = false;
+}
+
+int32_t watch_led_play(const watch_led_keyframe_t *keyframes, uint8_t count, bool loop) {
+    uint16_t lengths[WATCH_LED_MAX_KEYFRAMES];
+    uint16_t used = 0;
+    uint8_t red, green;
+    struct _dma_resource *resource;
+
+    if (!PWM_0_enabled) return ERR_NOT_INITIALIZED;
+    if (keyframes == NULL || !count || count > WATCH_LED_MAX_KEYFRAMES) return ERR_INVALID_ARG;
+    for (uint8_t i = 0; i < count; i++) {
+        lengths[i] = (uint32_t)keyframes[i].duration * (WATCH_LED_CLOCK_HZ / (WATCH_LED_PWM_TOP + 1)) / 1000;
+        if (!lengths[i]) lengths[i] = 1;
+        used += keyframes[i].fade ? lengths[i] : 1;
+        if (used > WATCH_LED_MAX_FRAMES) return ERR_INVALID_ARG;
+    }
+
+    if (led_effect_active) _watch_led_end_effect();
+    _watch_enable_dma();
+
+    // Render each block, starting each fade from the colour the one before it ends on.
+    red = loop ? keyframes[count - 1].red : 0;
+    green = loop ? keyframes[count - 1].green : 0;
+    used = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t *frames = led_frames + used;
+        if (keyframes[i].fade) {
+            for (uint16_t k = 1; k <= lengths[i]; k++) {
+                uint8_t r = red + ((int32_t)keyframes[i].red - red) * k / lengths[i];
+                uint8_t g = green + ((int32_t)keyframes[i].green - green) * k / lengths[i];
+                frames[k - 1] = r | g << 8;
+            }
+            used += lengths[i];
+        } else {
+            frames[0] = keyframes[i].red | keyframes[i].green << 8;
+            used++;
+        }
+        _watch_led_block(&led_descriptors[i], frames, lengths[i], keyframes[i].fade);
+        if (i) hri_dmacdescriptor_write_DESCADDR_reg(&led_descriptors[i - 1], (uint32_t)&led_descriptors[i]);
+        red = keyframes[i].red;
+        green = keyframes[i].green;
+    }
+    if (loop) {
+        hri_dmacdescriptor_write_DESCADDR_reg(&led_descriptors[count - 1], (uint32_t)&led_descriptors[0]);
+    } else {
+        hri_dmacdescriptor_write_BTCTRL_BLOCKACT_bf(&led_descriptors[count - 1], DMAC_BTCTRL_BLOCKACT_INT_Val);
+    }
+
+    // The section descriptor interrupts at the end of its block, as configured; a one-shot effect
+    // is over at that interrupt if it has one block, and at the last block's otherwise.
+    led_interrupts_left = loop ? 0 : (count == 1 ? 1 : 2);
+    _dma_get_channel_resource(&resource, WATCH_DMA_CHANNEL_LED);
+    resource->dma_cb.transfer_done = _watch_led_done;
+    resource->dma_cb.error = _watch_led_error;
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_LED, DMA_TRANSFER_COMPLETE_CB, true);
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_LED, DMA_TRANSFER_ERROR_CB, true);
+    _dma_srcinc_enable(WATCH_DMA_CHANNEL_LED, keyframes[0].fade);
+    _dma_set_source_address(WATCH_DMA_CHANNEL_LED, led_frames);
+    _dma_set_destination_address(WATCH_DMA_CHANNEL_LED, (void *)&TC3->COUNT8.CC[0].reg);
+    _dma_set_data_amount(WATCH_DMA_CHANNEL_LED, lengths[0]);
+    _dma_set_next_descriptor_address(WATCH_DMA_CHANNEL_LED,
+                                     count > 1 ? &led_descriptors[1] : (loop ? &led_descriptors[0] : NULL));
+
+    // PWM_0 runs TC3 in 16-bit match PWM, where CC0 sets the period; an effect needs both compare
+    // channels as duty cycles, so it has TC3 count to PER in 8-bit normal PWM instead.
+    hri_tc_clear_CTRLA_ENABLE_bit(TC3);
+    hri_tc_write_CTRLA_reg(TC3, TC_CTRLA_SWRST);
+    hri_tc_wait_for_sync(TC3, TC_SYNCBUSY_SWRST);
+    hri_tc_write_CTRLA_reg(TC3, TC_CTRLA_MODE_COUNT8 | TC_CTRLA_PRESCALER_DIV1 | TC_CTRLA_RUNSTDBY);
+    hri_tc_write_WAVE_reg(TC3, TC_WAVE_WAVEGEN_NPWM);
+    hri_tccount8_write_PER_reg(TC3, WATCH_LED_PWM_TOP);
+    // Until the first overflow brings in the first frame, show the colour the effect starts from.
+    hri_tccount8_write_CC_reg(TC3, 0, loop ? keyframes[count - 1].red : 0);
+    hri_tccount8_write_CC_reg(TC3, 1, loop ? keyframes[count - 1].green : 0);
+
+    led_effect_active = true;
+    led_playing = true;
+    _dma_enable_transaction(WATCH_DMA_CHANNEL_LED, false);
+    hri_tc_set_CTRLA_ENABLE_bit(TC3);
+
+    return ERR_NONE;
+}
+
+void watch_led_stop() {
+    if (!led_effect_active) return;
+
+    _watch_led_end_effect();
+    _watch_led_start_pwm();
+    watch_set_led_off();
+}
+
+bool watch_led_is_playing() {
+    return led_playing;
 }
 
+// ADC. Conversions end in the ADC interrupt instead of a busy-wait on RESRDY, and AVGCTRL has
+// the ADC accumulate and scale samples itself, so averaging costs no CPU either. A monitor goes
+// further: the RTC's periodic event starts each conversion through the event system, and the
+// window monitor interrupts only for a result on the far side of the window. The handler then
+// flips the window to wait for the crossing back, so a steady signal never wakes the core.
+// A capture has an event start conversions at a fixed rate too, the RTC's for the power-of-two
+// rates it has and TC2's overflow for the rest, but the DMAC moves every result into a ring
+// buffer; its two halves end in linked descriptors that each interrupt once, when full.
+//
+// The ADC runs from GCLK1, a generator that runs in STANDBY from OSC16M on demand. With RUNSTDBY
+// and ONDEMAND set the ADC requests that clock only while it converts, and main.c can keep
+// sleeping in STANDBY throughout.
+#define WATCH_EVSYS_CHANNEL_ADC 0           // RTC PERn or TC2 OVF to ADC START
+#define WATCH_ADC_CAPTURE_CLOCK_HZ 32768    // TC2 counts GCLK3, like TC3 for the LED
+
+typedef enum {
+    WATCH_ADC_MODE_NONE = 0,
+    WATCH_ADC_MODE_CONVERT,     // a watch_adc_start() conversion is in flight
+    WATCH_ADC_MODE_MONITOR,
+    WATCH_ADC_MODE_CAPTURE,
+} watch_adc_mode_t;
+
 static bool ADC_0_ENABLED = false;
+static volatile watch_adc_mode_t adc_mode = WATCH_ADC_MODE_NONE;
+static uint8_t adc_pin;
+static watch_adc_cb_t adc_callback;
+static bool adc_inside;                 // the monitor's last reported side of the window
+static struct _adc_dma_device adc_dma_device = { .hw = ADC };
+static watch_adc_capture_cb_t adc_capture_callback;
+static uint16_t *adc_capture_buffer;
+static uint16_t adc_capture_half;       // samples in each half of the ring
+static bool adc_capture_second_half;    // the half whose completion comes next
+static bool adc_capture_timer;          // TC2 paces the capture
+static uint32_t adc_capture_rate;       // conversions per second, as generated
+// The section descriptor fills the first half once; after that the DMAC alternates these two.
+COMPILER_ALIGNED(16) static DmacDescriptor adc_capture_descriptors[2];
 
-void watch_enable_analog(const uint8_t pin) {
-    if (!ADC_0_ENABLED) ADC_0_init();
+static int8_t _watch_adc_input(const uint8_t pin) {
+    switch (pin) {
+        case A0: return ADC_INPUTCTRL_MUXPOS_AIN12_Val;
+        case A1: return ADC_INPUTCTRL_MUXPOS_AIN9_Val;
+        case A2: return ADC_INPUTCTRL_MUXPOS_AIN10_Val;
+        default: return -1;
+    }
+}
+
+static void _watch_enable_adc(void) {
+    if (ADC_0_ENABLED) return;
+    ADC_0_init();
+    hri_adc_set_CTRLA_reg(ADC, ADC_CTRLA_RUNSTDBY | ADC_CTRLA_ONDEMAND | ADC_CTRLA_ENABLE);
+    NVIC_ClearPendingIRQ(ADC_IRQn);
+    NVIC_EnableIRQ(ADC_IRQn);
     ADC_0_ENABLED = true;
+}
+
+// EVCTRL is enable-protected.
+static void _watch_adc_set_start_input(bool enabled) {
+    hri_adc_clear_CTRLA_ENABLE_bit(ADC);
+    hri_adc_write_EVCTRL_STARTEI_bit(ADC, enabled);
+    hri_adc_set_CTRLA_ENABLE_bit(ADC);
+}
+
+// Has each event from generator start a conversion, or none if it is 0. The event system uses
+// the asynchronous path, which needs no clock of its own.
+static void _watch_adc_route_start(uint8_t generator) {
+    if (!generator) {
+        hri_evsys_write_USER_reg(EVSYS, EVSYS_ID_USER_ADC_START, 0);
+        hri_evsys_write_CHANNEL_reg(EVSYS, WATCH_EVSYS_CHANNEL_ADC, 0);
+        _watch_adc_set_start_input(false);
+        return;
+    }
+    _watch_adc_set_start_input(true);
+    hri_mclk_set_APBCMASK_EVSYS_bit(MCLK);
+    hri_evsys_write_CHANNEL_reg(EVSYS, WATCH_EVSYS_CHANNEL_ADC,
+                                EVSYS_CHANNEL_EVGEN(generator) | EVSYS_CHANNEL_PATH_ASYNCHRONOUS
+                                    | EVSYS_CHANNEL_EDGSEL_NO_EVT_OUTPUT | EVSYS_CHANNEL_RUNSTDBY);
+    hri_evsys_write_USER_reg(EVSYS, EVSYS_ID_USER_ADC_START, EVSYS_USER_CHANNEL(WATCH_EVSYS_CHANNEL_ADC + 1));
+}
+
+void ADC_Handler(void) {
+    uint8_t flags = hri_adc_read_INTFLAG_reg(ADC) & hri_adc_read_INTEN_reg(ADC);
+    uint16_t value = hri_adc_read_RESULT_reg(ADC);
+    watch_event_t event = { .button = adc_pin, .value = value };
+
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_RESRDY | ADC_INTFLAG_OVERRUN | ADC_INTFLAG_WINMON);
+    if (flags & ADC_INTFLAG_RESRDY) {
+        hri_adc_clear_INTEN_RESRDY_bit(ADC);
+        adc_mode = WATCH_ADC_MODE_NONE;
+        event.type = WATCH_EVENT_ADC;
+    } else if (flags & ADC_INTFLAG_WINMON) {
+        adc_inside = !adc_inside;
+        hri_adc_write_CTRLC_WINMODE_bf(ADC, adc_inside ? ADC_CTRLC_WINMODE_MODE4_Val : ADC_CTRLC_WINMODE_MODE3_Val);
+        event.type = WATCH_EVENT_ADC_WINDOW;
+    } else {
+        return;
+    }
+
+    if (adc_callback) adc_callback(adc_pin, value);
+    else _watch_post_event(event);
+}
+
+void watch_adc_set_averaging(uint16_t samples) {
+    uint8_t samplenum = 0;
+
+    while (samplenum < 10 && (2u << samplenum) <= samples) samplenum++;
+    _watch_enable_adc();
+    // Sums wider than 16 bits are shifted down to 16 before ADJRES, which divides by up to 16.
+    hri_adc_write_AVGCTRL_reg(ADC, ADC_AVGCTRL_SAMPLENUM(samplenum) | ADC_AVGCTRL_ADJRES(samplenum < 4 ? samplenum : 4));
+    hri_adc_write_CTRLC_RESSEL_bf(ADC, samplenum ? ADC_CTRLC_RESSEL_16BIT_Val : ADC_CTRLC_RESSEL_12BIT_Val);
+}
+
+int32_t watch_adc_start(uint8_t pin, watch_adc_cb_t callback) {
+    int8_t input = _watch_adc_input(pin);
+
+    if (input < 0) return ERR_INVALID_ARG;
+    if (adc_mode != WATCH_ADC_MODE_NONE) return ERR_BUSY;
+    _watch_enable_adc();
+
+    adc_pin = pin;
+    adc_callback = callback;
+    adc_mode = WATCH_ADC_MODE_CONVERT;
+    hri_adc_write_INPUTCTRL_MUXPOS_bf(ADC, input);
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_RESRDY);
+    hri_adc_set_INTEN_RESRDY_bit(ADC);
+    hri_adc_set_SWTRIG_START_bit(ADC);
+
+    return ERR_NONE;
+}
+
+// The handler has already stored the result; watch_adc_read() only needs the conversion done.
+static void _watch_adc_read_done(uint8_t pin, uint16_t value) {
+    (void)pin;
+    (void)value;
+}
+
+uint16_t watch_adc_read(uint8_t pin) {
+    if (watch_adc_start(pin, _watch_adc_read_done) != ERR_NONE) return 0;
+
+    // As in watch_i2c_wait(), WFI returns for the interrupt that PRIMASK holds off.
+    __disable_irq();
+    while (adc_mode == WATCH_ADC_MODE_CONVERT) {
+        sleep(watch_get_sleep_mode());
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+
+    return hri_adc_read_RESULT_reg(ADC);
+}
+
+int32_t watch_adc_monitor(uint8_t pin, uint16_t low, uint16_t high, watch_tick_rate_t rate, watch_adc_cb_t callback) {
+    int8_t input = _watch_adc_input(pin);
+
+    if (input < 0 || rate < WATCH_TICK_1_HZ || low >= high) return ERR_INVALID_ARG;
+    watch_adc_stop_monitor();
+    if (adc_mode != WATCH_ADC_MODE_NONE) return ERR_BUSY;
+    _watch_enable_adc();
+
+    adc_pin = pin;
+    adc_callback = callback;
+    adc_inside = true;
+    hri_adc_write_INPUTCTRL_MUXPOS_bf(ADC, input);
+    hri_adc_write_WINLT_reg(ADC, low);
+    hri_adc_write_WINUT_reg(ADC, high);
+    hri_adc_write_CTRLC_WINMODE_bf(ADC, ADC_CTRLC_WINMODE_MODE4_Val);
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_WINMON);
+    hri_adc_set_INTEN_WINMON_bit(ADC);
+    // The RTC's PERn outputs are all enabled at init.
+    _watch_adc_route_start(EVSYS_ID_GEN_RTC_PER_0 + WATCH_TICK_128_HZ - rate);
+    adc_mode = WATCH_ADC_MODE_MONITOR;
+
+    return ERR_NONE;
+}
+
+void watch_adc_stop_monitor() {
+    if (adc_mode != WATCH_ADC_MODE_MONITOR) return;
+
+    CRITICAL_SECTION_ENTER();
+    _watch_adc_route_start(0);
+    hri_adc_clear_INTEN_WINMON_bit(ADC);
+    hri_adc_write_CTRLC_WINMODE_bf(ADC, ADC_CTRLC_WINMODE_DISABLE_Val);
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_RESRDY | ADC_INTFLAG_OVERRUN | ADC_INTFLAG_WINMON);
+    adc_mode = WATCH_ADC_MODE_NONE;
+    CRITICAL_SECTION_LEAVE();
+}
+
+// Returns the RTC periodic event that fires at sample_rate, or 0 if none does.
+static uint8_t _watch_adc_rtc_generator(uint32_t sample_rate) {
+    for (uint8_t per = 0; per < 8; per++) {
+        if (sample_rate == 128u >> per) return EVSYS_ID_GEN_RTC_PER_0 + per;
+    }
+
+    return 0;
+}
+
+// Runs TC2 as a 16-bit counter that overflows every period cycles of its 32768 Hz clock, with its
+// overflow event on. TC2 shares its peripheral clock channel with TC3, which takes GCLK3 as well.
+static void _watch_adc_start_timer(uint16_t period) {
+    hri_mclk_set_APBCMASK_TC2_bit(MCLK);
+    hri_gclk_write_PCHCTRL_reg(GCLK, TC2_GCLK_ID, GCLK_PCHCTRL_GEN_GCLK3 | GCLK_PCHCTRL_CHEN);
+    hri_tc_write_CTRLA_reg(TC2, TC_CTRLA_SWRST);
+    hri_tc_write_CTRLA_reg(TC2, TC_CTRLA_MODE_COUNT16 | TC_CTRLA_RUNSTDBY);
+    hri_tc_write_WAVE_reg(TC2, TC_WAVE_WAVEGEN_MFRQ);
+    hri_tccount16_write_CC_reg(TC2, 0, period - 1);
+    hri_tc_write_EVCTRL_reg(TC2, TC_EVCTRL_OVFEO);
+    hri_tc_set_CTRLA_ENABLE_bit(TC2);
+}
+
+static void _watch_adc_capture_descriptor(DmacDescriptor *descriptor, uint16_t *samples, DmacDescriptor *next) {
+    hri_dmacdescriptor_write_BTCTRL_reg(descriptor, DMAC_BTCTRL_VALID | DMAC_BTCTRL_BEATSIZE_HWORD | DMAC_BTCTRL_DSTINC
+                                                        | DMAC_BTCTRL_BLOCKACT_INT);
+    hri_dmacdescriptor_write_BTCNT_reg(descriptor, adc_capture_half);
+    hri_dmacdescriptor_write_SRCADDR_reg(descriptor, _adc_get_source_for_dma(&adc_dma_device));
+    // With DSTINC set the descriptor holds the address just past the block.
+    hri_dmacdescriptor_write_DSTADDR_reg(descriptor, (uint32_t)(samples + adc_capture_half));
+    hri_dmacdescriptor_write_DESCADDR_reg(descriptor, (uint32_t)next);
+}
+
+static void _watch_adc_capture_done(struct _dma_resource *resource) {
+    uint16_t *samples = adc_capture_buffer + (adc_capture_second_half ? adc_capture_half : 0);
+
+    (void)resource;
+    // A block that completed just before watch_adc_capture_stop() disabled the channel.
+    if (adc_mode != WATCH_ADC_MODE_CAPTURE) return;
+    adc_capture_second_half = !adc_capture_second_half;
+    if (adc_capture_callback) adc_capture_callback(samples, adc_capture_half);
+    else _watch_post_event((watch_event_t){ .type = WATCH_EVENT_ADC_CAPTURE, .button = adc_pin, .samples = samples });
+}
+
+static void _watch_adc_capture_error(struct _dma_resource *resource) {
+    (void)resource;
+    watch_adc_capture_stop();
+}
+
+int32_t watch_adc_capture_start(uint8_t pin, uint16_t *buffer, uint16_t length, uint32_t sample_rate, watch_adc_capture_cb_t callback) {
+    int8_t input = _watch_adc_input(pin);
+    uint8_t generator = _watch_adc_rtc_generator(sample_rate);
+    struct _dma_resource *resource;
+
+    if (input < 0 || buffer == NULL || length < 2 || length % 2) return ERR_INVALID_ARG;
+    if (!sample_rate || sample_rate > WATCH_ADC_CAPTURE_CLOCK_HZ) return ERR_INVALID_ARG;
+    if (adc_mode != WATCH_ADC_MODE_NONE) return ERR_BUSY;
+    _watch_enable_adc();
+    _watch_enable_dma();
+
+    adc_pin = pin;
+    adc_capture_callback = callback;
+    adc_capture_buffer = buffer;
+    adc_capture_half = length / 2;
+    adc_capture_second_half = false;
+    _watch_adc_capture_descriptor(&adc_capture_descriptors[0], buffer, &adc_capture_descriptors[1]);
+    _watch_adc_capture_descriptor(&adc_capture_descriptors[1], buffer + adc_capture_half, &adc_capture_descriptors[0]);
+
+    _dma_get_channel_resource(&resource, WATCH_DMA_CHANNEL_ADC);
+    resource->dma_cb.transfer_done = _watch_adc_capture_done;
+    resource->dma_cb.error = _watch_adc_capture_error;
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_ADC, DMA_TRANSFER_COMPLETE_CB, true);
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_ADC, DMA_TRANSFER_ERROR_CB, true);
+    _dma_set_source_address(WATCH_DMA_CHANNEL_ADC, (void *)_adc_get_source_for_dma(&adc_dma_device));
+    _dma_set_destination_address(WATCH_DMA_CHANNEL_ADC, buffer);
+    _dma_set_data_amount(WATCH_DMA_CHANNEL_ADC, adc_capture_half);
+    _dma_set_next_descriptor_address(WATCH_DMA_CHANNEL_ADC, &adc_capture_descriptors[1]);
+    _dma_enable_transaction(WATCH_DMA_CHANNEL_ADC, false);
+
+    hri_adc_write_INPUTCTRL_MUXPOS_bf(ADC, input);
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_RESRDY | ADC_INTFLAG_OVERRUN);
+    adc_capture_timer = !generator;
+    adc_capture_rate = sample_rate;
+    if (adc_capture_timer) {
+        // TC2 makes only 32768 / n Hz; take the nearest such rate.
+        uint16_t period = (WATCH_ADC_CAPTURE_CLOCK_HZ + sample_rate / 2) / sample_rate;
+        _watch_adc_start_timer(period);
+        adc_capture_rate = WATCH_ADC_CAPTURE_CLOCK_HZ / period;
+        generator = EVSYS_ID_GEN_TC2_OVF;
+    }
+    _watch_adc_route_start(generator);
+    adc_mode = WATCH_ADC_MODE_CAPTURE;
+
+    return ERR_NONE;
+}
+
+void watch_adc_capture_stop() {
+    if (adc_mode != WATCH_ADC_MODE_CAPTURE) return;
+
+    CRITICAL_SECTION_ENTER();
+    _watch_adc_route_start(0);
+    if (adc_capture_timer) hri_tc_clear_CTRLA_ENABLE_bit(TC2);
+    _watch_dma_disable_channel(WATCH_DMA_CHANNEL_ADC);
+    hri_adc_clear_INTFLAG_reg(ADC, ADC_INTFLAG_RESRDY | ADC_INTFLAG_OVERRUN);
+    adc_mode = WATCH_ADC_MODE_NONE;
+    CRITICAL_SECTION_LEAVE();
+}
+
+uint32_t watch_adc_capture_get_rate() {
+    return adc_mode == WATCH_ADC_MODE_CAPTURE ? adc_capture_rate : 0;
+}
+
+void watch_enable_analog(const uint8_t pin) {
+    _watch_enable_adc();
 
     gpio_set_pin_direction(pin, GPIO_DIRECTION_OFF);
     switch (pin) {
@@ -327,22 +1262,551 @@ void watch_set_pin_level(const uint8_t pin, const bool level) {
     gpio_set_pin_level(pin, level);
 }
 
+// I2C. The blocking calls poll SERCOM1 through I2C_0. Queued transactions use a second,
+// interrupt-driven view of the same SERCOM: each segment starts from the interrupt that ended the
+// one before, so the core sleeps in IDLE from submission to callback. The two never overlap: a
+// blocking call waits for the queue to drain and holds i2c_blocking until it is done, and
+// watch_i2c_submit() leaves anything it queues meanwhile for the release to start. The SERCOM's
+// interrupts stay disabled while nothing queued is on the bus.
+//
+// Segments of WATCH_I2C_DMA_MIN_LENGTH bytes or more go through the DMAC instead of taking an
+// interrupt per byte. The SERCOM counts them itself (ADDR.LENEN), NACKs the last byte of a read
+// and ends with a stop, so a FIFO drain costs the register-pointer write and one DMAC interrupt.
+// A write ends when its last byte has left the shifter, one MB interrupt after the DMAC's. LEN
+// is eight bits wide, and the automatic stop rules out a DMA write that a read follows; those
+// segments take the interrupt path.
+#define WATCH_I2C_DMA_MIN_LENGTH 4
+#define WATCH_I2C_DMA_MAX_LENGTH 255
+
 struct io_descriptor *I2C_0_io;
+static struct _i2c_m_async_device I2C_0_async;
+static watch_i2c_transaction_t *i2c_queue = NULL;  // the head is on the bus, unless i2c_blocking
+static bool i2c_blocking = false;                  // a blocking call owns the bus
+static uint8_t i2c_dma_channel = WATCH_DMA_CHANNEL_NONE;
+
+static bool _watch_i2c_use_dma(watch_i2c_transaction_t *transaction, bool read) {
+    uint16_t length = read ? transaction->read_length : transaction->write_length;
+
+    if (length < WATCH_I2C_DMA_MIN_LENGTH || length > WATCH_I2C_DMA_MAX_LENGTH) return false;
+    return read || !transaction->read_length;
+}
+
+static void _watch_i2c_start_dma(struct _i2c_m_msg *msg) {
+    void *hw = I2C_0_async.hw;
+    bool read = msg->flags & I2C_M_RD;
+
+    // The message stands in for the hpl handler, which still sees an address NACK on a read.
+    msg->flags |= I2C_M_BUSY;
+    I2C_0_async.service.msg = *msg;
+    if (read) {
+        i2c_dma_channel = WATCH_DMA_CHANNEL_I2C_RX;
+        _dma_set_source_address(i2c_dma_channel, (void *)&((Sercom *)hw)->I2CM.DATA.reg);
+        _dma_set_destination_address(i2c_dma_channel, msg->buffer);
+    } else {
+        i2c_dma_channel = WATCH_DMA_CHANNEL_I2C_TX;
+        _dma_set_source_address(i2c_dma_channel, msg->buffer);
+        _dma_set_destination_address(i2c_dma_channel, (void *)&((Sercom *)hw)->I2CM.DATA.reg);
+    }
+    _dma_set_data_amount(i2c_dma_channel, msg->len);
+    _dma_enable_transaction(i2c_dma_channel, false);
+
+    // SB comes up for every byte the DMAC moves, and MB for every byte of a write.
+    hri_sercomi2cm_write_INTEN_SB_bit(hw, false);
+    hri_sercomi2cm_write_INTEN_MB_bit(hw, read);
+    hri_sercomi2cm_clear_CTRLB_ACKACT_bit(hw);
+    hri_sercomi2cm_set_CTRLB_SMEN_bit(hw);
+    hri_sercomi2cm_write_ADDR_reg(hw, (msg->addr << 1) | (read ? I2C_M_RD : 0)
+                                          | SERCOM_I2CM_ADDR_LENEN | SERCOM_I2CM_ADDR_LEN(msg->len)
+                                          | (hri_sercomi2cm_read_ADDR_reg(hw) & SERCOM_I2CM_ADDR_HS));
+}
+
+static void _watch_i2c_start(watch_i2c_transaction_t *transaction, bool read) {
+    struct _i2c_m_msg msg;
+
+    msg.addr = transaction->addr;
+    if (read) {
+        msg.flags = I2C_M_RD | I2C_M_STOP;
+        msg.buffer = transaction->read_buf;
+        msg.len = transaction->read_length;
+    } else {
+        // Without a stop, the read that follows begins with a repeated start.
+        msg.flags = transaction->read_length ? 0 : I2C_M_STOP;
+        msg.buffer = (uint8_t *)transaction->write_buf;
+        msg.len = transaction->write_length;
+    }
+    if (_watch_i2c_use_dma(transaction, read)) {
+        _watch_i2c_start_dma(&msg);
+        return;
+    }
+    _i2c_m_async_set_irq_state(&I2C_0_async, I2C_M_ASYNC_DEVICE_TX_COMPLETE, true);
+    _i2c_m_async_transfer(&I2C_0_async, &msg);
+}
+
+static void _watch_i2c_finish(int32_t status) {
+    watch_i2c_transaction_t *transaction = i2c_queue;
+
+    i2c_queue = transaction->next;
+    if (i2c_queue != NULL) {
+        _watch_i2c_start(i2c_queue, !i2c_queue->write_length);
+    } else {
+        _i2c_m_async_set_irq_state(&I2C_0_async, I2C_M_ASYNC_DEVICE_TX_COMPLETE, false);
+        _i2c_m_async_set_irq_state(&I2C_0_async, I2C_M_ASYNC_DEVICE_ERROR, false);
+    }
+
+    transaction->status = status;
+    if (transaction->callback) transaction->callback(transaction);
+    else _watch_post_event((watch_event_t){ .type = WATCH_EVENT_I2C, .transaction = transaction });
+}
+
+static void _watch_i2c_tx_complete(struct _i2c_m_async_device *const dev) {
+    (void)dev;
+    if (i2c_queue->read_length) _watch_i2c_start(i2c_queue, true);
+    else _watch_i2c_finish(I2C_OK);
+}
+
+static void _watch_i2c_rx_complete(struct _i2c_m_async_device *const dev) {
+    (void)dev;
+    _watch_i2c_finish(I2C_OK);
+}
+
+static void _watch_i2c_error(struct _i2c_m_async_device *const dev, int32_t status) {
+    if (i2c_dma_channel != WATCH_DMA_CHANNEL_NONE) {
+        _watch_dma_disable_channel(i2c_dma_channel);
+        i2c_dma_channel = WATCH_DMA_CHANNEL_NONE;
+        // A slave that NACKs before LEN bytes have gone out ends the write early, with a stop.
+        if (hri_sercomi2cm_get_STATUS_LENERR_bit(dev->hw)) {
+            hri_sercomi2cm_clear_STATUS_reg(dev->hw, SERCOM_I2CM_STATUS_LENERR);
+            status = I2C_NACK;
+        }
+    }
+    // A NACK ends the message, but only a message that ends the transaction sends a stop.
+    if (status == I2C_NACK && !(dev->service.msg.flags & I2C_M_STOP)) _i2c_m_async_send_stop(dev);
+    _watch_i2c_finish(status);
+}
+
+static void _watch_i2c_dma_done(struct _dma_resource *resource) {
+    (void)resource;
+    if (i2c_dma_channel == WATCH_DMA_CHANNEL_I2C_RX) {
+        // The SERCOM NACKed the last byte and sent the stop before the DMAC read it.
+        i2c_dma_channel = WATCH_DMA_CHANNEL_NONE;
+        I2C_0_async.service.msg.flags &= ~I2C_M_BUSY;
+        _watch_i2c_finish(I2C_OK);
+    } else if (i2c_dma_channel == WATCH_DMA_CHANNEL_I2C_TX) {
+        // The last byte is still going out; the hpl handler sees it off as an empty message.
+        i2c_dma_channel = WATCH_DMA_CHANNEL_NONE;
+        I2C_0_async.service.msg.len = 0;
+        hri_sercomi2cm_write_INTEN_MB_bit(I2C_0_async.hw, true);
+    }
+}
+
+static void _watch_i2c_dma_error(struct _dma_resource *resource) {
+    (void)resource;
+    _watch_i2c_error(&I2C_0_async, I2C_ERR_BUS);
+}
 
 void watch_enable_i2c() {
     I2C_0_init();
+    // Both views configure the SERCOM identically; this one also enables its interrupt line.
+    _i2c_m_async_init(&I2C_0_async, SERCOM1);
+    _i2c_m_async_register_callback(&I2C_0_async, I2C_M_ASYNC_DEVICE_TX_COMPLETE, (FUNC_PTR)_watch_i2c_tx_complete);
+    _i2c_m_async_register_callback(&I2C_0_async, I2C_M_ASYNC_DEVICE_RX_COMPLETE, (FUNC_PTR)_watch_i2c_rx_complete);
+    _i2c_m_async_register_callback(&I2C_0_async, I2C_M_ASYNC_DEVICE_ERROR, (FUNC_PTR)_watch_i2c_error);
+
+    _watch_enable_dma();
+    for (uint8_t channel = WATCH_DMA_CHANNEL_I2C_RX; channel <= WATCH_DMA_CHANNEL_I2C_TX; channel++) {
+        struct _dma_resource *resource;
+        _dma_get_channel_resource(&resource, channel);
+        resource->dma_cb.transfer_done = _watch_i2c_dma_done;
+        resource->dma_cb.error = _watch_i2c_dma_error;
+        _dma_set_irq_state(channel, DMA_TRANSFER_COMPLETE_CB, true);
+        _dma_set_irq_state(channel, DMA_TRANSFER_ERROR_CB, true);
+    }
+
     i2c_m_sync_get_io_descriptor(&I2C_0, &I2C_0_io);
     i2c_m_sync_enable(&I2C_0);
 }
 
+static void _watch_i2c_start_queue(void) {
+    _i2c_m_async_set_irq_state(&I2C_0_async, I2C_M_ASYNC_DEVICE_ERROR, true);
+    _watch_i2c_start(i2c_queue, !i2c_queue->write_length);
+}
+
+// Waits for the queue to drain, then takes the bus from watch_i2c_submit() in the same masked
+// stretch, so nothing an interrupt submits can start in between.
+static void _watch_i2c_claim(void) {
+    __disable_irq();
+    while (i2c_queue != NULL) {
+        sleep(watch_get_sleep_mode());
+        __enable_irq();
+        __disable_irq();
+    }
+    i2c_blocking = true;
+    __enable_irq();
+}
+
+// Hands the bus back, starting whatever was submitted while the blocking call held it.
+static void _watch_i2c_release(void) {
+    CRITICAL_SECTION_ENTER();
+    i2c_blocking = false;
+    if (i2c_queue != NULL) _watch_i2c_start_queue();
+    CRITICAL_SECTION_LEAVE();
+}
+
 void watch_i2c_send(int16_t addr, uint8_t *buf, uint16_t length) {
+    _watch_i2c_claim();
     i2c_m_sync_set_slaveaddr(&I2C_0, addr, I2C_M_SEVEN);
     io_write(I2C_0_io, buf, length);
+    _watch_i2c_release();
 }
 
 void watch_i2c_receive(int16_t addr, uint8_t *buf, uint16_t length) {
+    _watch_i2c_claim();
     i2c_m_sync_set_slaveaddr(&I2C_0, addr, I2C_M_SEVEN);
     io_read(I2C_0_io, buf, length);
+    _watch_i2c_release();
+}
+
+int32_t watch_i2c_transfer(int16_t addr, watch_i2c_message_t *messages, uint8_t count) {
+    struct _i2c_m_msg msg = { .flags = I2C_M_STOP };
+    int32_t ret = I2C_OK;
+
+    _watch_i2c_claim();
+    for (uint8_t i = 0; i < count && ret == I2C_OK; i++) {
+        msg.addr = addr;
+        msg.flags = (messages[i].read ? I2C_M_RD : 0) | (i == count - 1 ? I2C_M_STOP : 0);
+        msg.buffer = messages[i].buf;
+        msg.len = messages[i].length;
+        ret = i2c_m_sync_transfer(&I2C_0, &msg);
+    }
+    // The driver only stops the bus after a failure in a message that was meant to end with one.
+    if (ret != I2C_OK && !(msg.flags & I2C_M_STOP)) i2c_m_sync_send_stop(&I2C_0);
+    _watch_i2c_release();
+
+    return ret;
+}
+
+int32_t watch_i2c_write_read(int16_t addr, uint8_t *write_buf, uint16_t write_length, uint8_t *read_buf,
+                             uint16_t read_length) {
+    watch_i2c_message_t messages[] = {
+        { .buf = write_buf, .length = write_length, .read = false },
+        { .buf = read_buf, .length = read_length, .read = true },
+    };
+
+    return watch_i2c_transfer(addr, messages, 2);
+}
+
+int32_t watch_i2c_submit(watch_i2c_transaction_t *transaction) {
+    watch_i2c_transaction_t **link;
+
+    if (!transaction->write_length && !transaction->read_length) return ERR_INVALID_ARG;
+    transaction->status = WATCH_I2C_PENDING;
+    transaction->next = NULL;
+
+    CRITICAL_SECTION_ENTER();
+    for (link = &i2c_queue; *link != NULL; link = &(*link)->next);
+    *link = transaction;
+    if (i2c_queue == transaction && !i2c_blocking) _watch_i2c_start_queue();
+    CRITICAL_SECTION_LEAVE();
+
+    return ERR_NONE;
+}
+
+bool watch_i2c_is_busy() {
+    return i2c_queue != NULL;
+}
+
+void watch_i2c_wait() {
+    // WFI also returns for an interrupt that PRIMASK holds off, so testing the queue and going
+    // to sleep with interrupts masked cannot miss the completion.
+    __disable_irq();
+    while (i2c_queue != NULL) {
+        sleep(watch_get_sleep_mode());
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+}
+
+// Debug log. watch_log_write() copies into a ring buffer and returns at once; DMAC channel 3,
+// triggered by SERCOM3's DRE, feeds the USART from there, one run of bytes up to the end of the
+// buffer per transfer, so a line costs an interrupt or two rather than a busy-wait per byte. A
+// message that does not fit whole is dropped and counted, and nothing ever waits for room.
+//
+// SERCOM3 runs from GCLK0, which STANDBY stops, so watch_get_sleep_mode() asks for IDLE until TXC
+// says the last byte has left the shifter.
+#ifndef WATCH_LOG_BUFFER_SIZE
+#define WATCH_LOG_BUFFER_SIZE 512
+#endif
+#define WATCH_LOG_MAX_LINE 128  // watch_log_printf() formats on the stack, into this much
+#define WATCH_LOG_TX GPIO(GPIO_PORTB, 0)
+#define WATCH_LOG_RX GPIO(GPIO_PORTB, 2)
+
+static char log_buffer[WATCH_LOG_BUFFER_SIZE];
+static bool log_enabled = false;
+static uint16_t log_head = 0;           // where the next message goes
+static uint16_t log_tail = 0;           // the next byte to send
+static uint16_t log_count = 0;          // bytes queued, counting those the DMAC is moving
+static uint16_t log_sending = 0;        // bytes the DMAC is moving
+static volatile bool log_busy = false;  // the USART has bytes to shift out
+static uint32_t log_dropped = 0;
+
+// Hands the DMAC the queued bytes up to the end of the buffer, or waits for TXC if none are left.
+static void _watch_log_send(void) {
+    uint16_t run = WATCH_LOG_BUFFER_SIZE - log_tail;
+
+    if (run > log_count) run = log_count;
+    log_sending = run;
+    if (!run) {
+        hri_sercomusart_set_INTEN_TXC_bit(SERCOM3);
+        return;
+    }
+    log_busy = true;
+    hri_sercomusart_clear_INTEN_TXC_bit(SERCOM3);
+    hri_sercomusart_clear_INTFLAG_reg(SERCOM3, SERCOM_USART_INTFLAG_TXC);
+    _dma_set_source_address(WATCH_DMA_CHANNEL_LOG, log_buffer + log_tail);
+    _dma_set_destination_address(WATCH_DMA_CHANNEL_LOG, (void *)&SERCOM3->USART.DATA.reg);
+    _dma_set_data_amount(WATCH_DMA_CHANNEL_LOG, run);
+    _dma_enable_transaction(WATCH_DMA_CHANNEL_LOG, false);
+}
+
+static void _watch_log_dma_done(struct _dma_resource *resource) {
+    (void)resource;
+    log_tail = (log_tail + log_sending) % WATCH_LOG_BUFFER_SIZE;
+    log_count -= log_sending;
+    _watch_log_send();
+}
+
+// A bus error loses what the DMAC was moving; the rest of the queue still goes out.
+static void _watch_log_dma_error(struct _dma_resource *resource) {
+    log_dropped++;
+    _watch_log_dma_done(resource);
+}
+
+void SERCOM3_Handler(void) {
+    if (!(hri_sercomusart_read_INTFLAG_reg(SERCOM3) & hri_sercomusart_read_INTEN_reg(SERCOM3) & SERCOM_USART_INTFLAG_TXC)) return;
+    hri_sercomusart_clear_INTEN_TXC_bit(SERCOM3);
+    hri_sercomusart_clear_INTFLAG_reg(SERCOM3, SERCOM_USART_INTFLAG_TXC);
+    if (!log_sending) log_busy = false;
+}
+
+void watch_enable_log(uint32_t baud) {
+    // Arithmetic baud generation, 16 samples per bit.
+    uint64_t br = (uint64_t)65536 * (CONF_CPU_FREQUENCY - 16 * baud) / CONF_CPU_FREQUENCY;
+    struct _dma_resource *resource;
+
+    if (log_enabled) return;
+    gpio_set_pin_direction(WATCH_LOG_TX, GPIO_DIRECTION_OUT);
+    gpio_set_pin_function(WATCH_LOG_TX, PINMUX_PB00C_SERCOM3_PAD2);
+    gpio_set_pin_direction(WATCH_LOG_RX, GPIO_DIRECTION_IN);
+    gpio_set_pin_function(WATCH_LOG_RX, PINMUX_PB02C_SERCOM3_PAD0);
+
+    hri_mclk_set_APBCMASK_SERCOM3_bit(MCLK);
+    hri_gclk_write_PCHCTRL_reg(GCLK, SERCOM3_GCLK_ID_CORE, GCLK_PCHCTRL_GEN_GCLK0 | GCLK_PCHCTRL_CHEN);
+    hri_sercomusart_write_CTRLA_reg(SERCOM3, SERCOM_USART_CTRLA_DORD | SERCOM_USART_CTRLA_MODE(1 /* internal clock */)
+                                                 | SERCOM_USART_CTRLA_RXPO(0 /* PAD0 */) | SERCOM_USART_CTRLA_TXPO(1 /* PAD2 */));
+    hri_sercomusart_write_CTRLB_reg(SERCOM3, SERCOM_USART_CTRLB_RXEN | SERCOM_USART_CTRLB_TXEN | SERCOM_USART_CTRLB_CHSIZE(0));
+    hri_sercomusart_write_BAUD_reg(SERCOM3, (uint16_t)br);
+    hri_sercomusart_set_CTRLA_ENABLE_bit(SERCOM3);
+    NVIC_ClearPendingIRQ(SERCOM3_IRQn);
+    NVIC_EnableIRQ(SERCOM3_IRQn);
+
+    _watch_enable_dma();
+    _dma_get_channel_resource(&resource, WATCH_DMA_CHANNEL_LOG);
+    resource->dma_cb.transfer_done = _watch_log_dma_done;
+    resource->dma_cb.error = _watch_log_dma_error;
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_LOG, DMA_TRANSFER_COMPLETE_CB, true);
+    _dma_set_irq_state(WATCH_DMA_CHANNEL_LOG, DMA_TRANSFER_ERROR_CB, true);
+    log_enabled = true;
+}
+
+bool watch_log_write(const char *buf, uint16_t length) {
+    uint16_t first;
+    bool queued = false;
+
+    if (!log_enabled) return false;
+    CRITICAL_SECTION_ENTER();
+    if (length > WATCH_LOG_BUFFER_SIZE - log_count) {
+        log_dropped++;
+    } else {
+        first = WATCH_LOG_BUFFER_SIZE - log_head;
+        if (first > length) first = length;
+        memcpy(log_buffer + log_head, buf, first);
+        memcpy(log_buffer, buf + first, length - first);
+        log_head = (log_head + length) % WATCH_LOG_BUFFER_SIZE;
+        log_count += length;
+        if (!log_sending) _watch_log_send();
+        queued = true;
+    }
+    CRITICAL_SECTION_LEAVE();
+
+    return queued;
+}
+
+bool watch_log_printf(const char *format, ...) {
+    char line[WATCH_LOG_MAX_LINE];
+    va_list args;
+    int length;
+
+    va_start(args, format);
+    length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (length < 0) return false;
+
+    return watch_log_write(line, length < (int)sizeof(line) ? length : (int)sizeof(line) - 1);
+}
+
+uint32_t watch_log_get_dropped() {
+    return log_dropped;
+}
+
+void watch_log_flush() {
+    // As in watch_i2c_wait().
+    __disable_irq();
+    while (log_busy) {
+        sleep(watch_get_sleep_mode());
+        __enable_irq();
+        __disable_irq();
+    }
+    __enable_irq();
+}
+
+// Delays. hal_delay.c offers delay_ms() and delay_us() calls of 2 ms or more to _delay_sleep_us(),
+// which arms the timebase's CC0 for the end of the wait and sleeps until it matches, rather than
+// spinning on SysTick at full power. The timebase runs in STANDBY, so unless the I2C queue or the
+// log needs the main clock, the wait costs the standby current. The match handler has to run for
+// the wait to end, so calls from an interrupt or with interrupts masked still spin.
+
+#define WATCH_DELAY_CHANNEL 0
+
+static volatile bool delay_waiting = false;
+
+void TC0_Handler(void) {
+    uint8_t flags = hri_tc_read_INTFLAG_reg(TC0) & hri_tc_read_INTEN_reg(TC0);
+
+    // OVF is left for the timestamps to fold in.
+    hri_tc_clear_INTFLAG_reg(TC0, flags);
+    if (flags & (TC_INTFLAG_MC0 << WATCH_DELAY_CHANNEL)) {
+        _watch_timebase_disarm(WATCH_DELAY_CHANNEL);
+        delay_waiting = false;
+    }
+    if (flags & (TC_INTFLAG_MC0 << WATCH_BUTTON_CHANNEL)) _watch_buttons_timeout();
+}
+
+bool _delay_sleep_us(const uint32_t us) {
+    // Rounded up, so the wait is never shorter than asked.
+    uint32_t ticks = ((uint64_t)us * WATCH_TIMEBASE_HZ + 999999) / 1000000;
+    uint32_t now;
+
+    if (__get_IPSR() || __get_PRIMASK()) return false;
+
+    CRITICAL_SECTION_ENTER();
+    now = _watch_timebase_hold(WATCH_TIMEBASE_DELAY) ? 0 : _watch_timebase_read();
+    delay_waiting = true;
+    _watch_timebase_arm(WATCH_DELAY_CHANNEL, now + ticks);
+    CRITICAL_SECTION_LEAVE();
+
+    // As in watch_i2c_wait().
+    __disable_irq();
+    while (delay_waiting) {
+        sleep(watch_get_sleep_mode());
+        __enable_irq();
+        __disable_irq();
+    }
+    _watch_timebase_release(WATCH_TIMEBASE_DELAY);
+    __enable_irq();
+
+    return true;
+}
+
+// Timestamps. SysTick counts CPU cycles and costs nothing to read, but it stops while the core
+// sleeps; the timebase counts through STANDBY, but a read takes a READSYNC. watch_cycles() uses
+// both: every wake anchors to the timebase in _sleep_exit(), and calls add the SysTick cycles
+// since, which _delay_cycles() leaves free-running. SysTick wraps every 2^24 cycles, so a call
+// that sees COUNTFLAG anchors again. An anchor never goes below the last value handed out, which
+// keeps the count monotonic across the timebase's coarser ticks.
+//
+// The timebase wraps every 36 hours, and each anchor folds in a wrap from its OVF flag, so no
+// interrupt wakes the core to count them. A wake job makes sure an anchor comes at least every
+// 24 hours; its window is 12 hours wide, so it almost always shares a wake with something else.
+
+#define WATCH_TIMESTAMP_WAKE_PERIOD (12 * 60 * 60)
+
+static bool timestamp_enabled = false;
+static uint32_t timestamp_overflows;
+static bool timestamp_anchored;
+static uint64_t timestamp_base;         // cycles at the anchor
+static uint32_t timestamp_systick;      // SysTick's VAL at the anchor
+static uint64_t timestamp_last;         // the last value returned
+static watch_wake_job_t timestamp_wake;
+
+// Runs with interrupts masked.
+static void _watch_timestamp_anchor() {
+    bool wrapped = hri_tc_get_INTFLAG_OVF_bit(TC0);
+    uint32_t count = _watch_timebase_read();
+    uint64_t ticks, base;
+
+    // A wrap between the two reads shows as a small count; a later one is left for next time.
+    if (!wrapped && hri_tc_get_INTFLAG_OVF_bit(TC0) && count < 0x80000000) wrapped = true;
+    if (wrapped) {
+        hri_tc_clear_INTFLAG_reg(TC0, TC_INTFLAG_OVF);
+        timestamp_overflows++;
+    }
+    // Reading CTRL clears COUNTFLAG, so it next comes up on a wrap after this anchor.
+    (void)SysTick->CTRL;
+    timestamp_systick = SysTick->VAL;
+
+    ticks = ((uint64_t)timestamp_overflows << 32) | count;
+    // Split, so that the product cannot overflow in any realistic uptime.
+    base = ticks / WATCH_TIMEBASE_HZ * CONF_CPU_FREQUENCY
+           + ticks % WATCH_TIMEBASE_HZ * CONF_CPU_FREQUENCY / WATCH_TIMEBASE_HZ;
+    timestamp_base = base > timestamp_last ? base : timestamp_last;
+    timestamp_anchored = true;
+}
+
+void _sleep_exit(void) {
+    if (!timestamp_enabled) return;
+
+    CRITICAL_SECTION_ENTER();
+    _watch_timestamp_anchor();
+    CRITICAL_SECTION_LEAVE();
+}
+
+// Only here to wake the core; _sleep_exit() has already anchored.
+static void _watch_timestamp_wake(void) {
+}
+
+void watch_enable_timestamps() {
+    if (timestamp_enabled) return;
+
+    CRITICAL_SECTION_ENTER();
+    _watch_timebase_hold(WATCH_TIMEBASE_TIMESTAMPS);
+    hri_tc_clear_INTFLAG_reg(TC0, TC_INTFLAG_OVF);
+    timestamp_overflows = 0;
+    timestamp_anchored = false;
+    timestamp_last = 0;
+    timestamp_enabled = true;
+    CRITICAL_SECTION_LEAVE();
+
+    watch_schedule_wake(&timestamp_wake, WATCH_TIMESTAMP_WAKE_PERIOD, WATCH_TIMESTAMP_WAKE_PERIOD,
+                        WATCH_TIMESTAMP_WAKE_PERIOD, _watch_timestamp_wake);
+}
+
+uint64_t watch_cycles() {
+    uint64_t cycles;
+
+    if (!timestamp_enabled) return 0;
+
+    CRITICAL_SECTION_ENTER();
+    if (!timestamp_anchored || (SysTick->CTRL & SysTick_CTRL_COUNTFLAG_Msk)) _watch_timestamp_anchor();
+    cycles = timestamp_base + ((timestamp_systick - SysTick->VAL) & SysTick_VAL_CURRENT_Msk);
+    timestamp_last = cycles;
+    CRITICAL_SECTION_LEAVE();
+
+    return cycles;
+}
+
+uint64_t watch_timestamp_us() {
+    return watch_cycles() / (CONF_CPU_FREQUENCY / 1000000);
 }
 
 void watch_store_backup_data(uint32_t data, uint8_t reg) {
@@ -359,6 +1823,12 @@ uint32_t watch_get_backup_data(uint8_t reg) {
     return 0;
 }
 
+uint8_t watch_get_sleep_mode() {
+    // STANDBY stops GCLK0, which clocks SERCOM1 and SERCOM3.
+    if (i2c_queue != NULL || log_busy) return PM_SLEEPCFG_SLEEPMODE_IDLE2_Val;
+    return PM_SLEEPCFG_SLEEPMODE_STANDBY_Val;
+}
+
 void watch_enter_deep_sleep(){
     // Not yet implemented.
     // TODO: enable tamper interrupt on ALARM pin.
@@ -4,12 +4,17 @@
 #include "driver_init.h"
 #include "hpl_calendar.h"
 #include "hal_ext_irq.h"
+#include "hpl_i2c_m_async.h"
 
 void watch_init();
 
 void watch_enable_display();
+// Drawing functions update a RAM copy of the display; call watch_display_commit() to show it.
 void watch_display_pixel(uint8_t com, uint8_t seg);
+void watch_clear_pixel(uint8_t com, uint8_t seg);
+void watch_display_character(uint8_t character, uint8_t position);
 void watch_display_string(char *string, uint8_t position);
+void watch_display_commit();
 
 void watch_enable_led(bool pwm);
 void watch_disable_led(bool pwm);
@@ -19,16 +24,153 @@ void watch_set_led_green();
 void watch_set_led_yellow();
 void watch_set_led_off();
 
+// LED effects. watch_led_play() renders a list of keyframes into a table of frames, and the DMAC
+// copies one frame into TC3's compare registers at each PWM period, so the core can sleep in
+// STANDBY through a whole fade or blink pattern. Needs watch_enable_led(true). While playing,
+// TC3 runs 8-bit PWM at 128 Hz, and colours go from 0 to 255; the next watch_set_led_color() or
+// watch_led_stop() goes back to the usual 16-bit PWM.
+typedef struct {
+    uint8_t red;
+    uint8_t green;
+    uint16_t duration;  // in ms, at least one frame (1/128 s)
+    bool fade;          // ramp from the previous keyframe's colour rather than jump to this one
+} watch_led_keyframe_t;
+// Plays count keyframes, once or over and over. A fade in the first keyframe starts from the last
+// keyframe's colour if looping, and from off otherwise; once through, the LED keeps the last
+// colour. Returns ERR_NOT_INITIALIZED without PWM, or ERR_INVALID_ARG if there are more than
+// WATCH_LED_MAX_KEYFRAMES keyframes or the fades need more than WATCH_LED_MAX_FRAMES frames.
+int32_t watch_led_play(const watch_led_keyframe_t *keyframes, uint8_t count, bool loop);
+// Stops the effect and turns the LED off.
+void watch_led_stop();
+bool watch_led_is_playing();
+
 bool watch_rtc_is_enabled();
-void watch_set_date_time(struct calendar_date_time date_time);
+// Sets the RTC's clock. Returns ERR_INVALID_ARG, leaving the clock alone, for a year outside
+// CONF_RTC_REFERENCE_YEAR to 63 years after it, or a month, day or time that does not exist.
+int32_t watch_set_date_time(struct calendar_date_time date_time);
 void watch_get_date_time(struct calendar_date_time *date_time);
 
 void watch_enable_tick_callback(ext_irq_cb_t callback);
 
+typedef enum {
+    WATCH_TICK_OFF = 0,
+    WATCH_TICK_PER_MINUTE,
+    WATCH_TICK_1_HZ,
+    WATCH_TICK_2_HZ,
+    WATCH_TICK_4_HZ,
+    WATCH_TICK_8_HZ,
+    WATCH_TICK_16_HZ,
+    WATCH_TICK_32_HZ,
+    WATCH_TICK_64_HZ,
+    WATCH_TICK_128_HZ,
+} watch_tick_rate_t;
+
+// Sets how often the tick callback runs (1 Hz until changed). A once-a-minute tick lands on the
+// minute boundary; WATCH_TICK_OFF stops the tick without unregistering the callback.
+void watch_set_tick_rate(watch_tick_rate_t rate);
+
+typedef void (*watch_wake_cb_t)(void);
+
+typedef struct watch_wake_job {
+    uint32_t earliest;
+    uint32_t latest;
+    uint32_t period;
+    watch_wake_cb_t callback;
+    struct watch_wake_job *next;
+} watch_wake_job_t;
+
+// Calls callback from the RTC interrupt between delay and delay + tolerance seconds from now,
+// on a wake shared with any other job due in that window; a nonzero period repeats it every
+// period seconds. Scheduling a job that is already pending moves it.
+void watch_schedule_wake(watch_wake_job_t *job, uint32_t delay, uint32_t tolerance, uint32_t period, watch_wake_cb_t callback);
+void watch_cancel_wake(watch_wake_job_t *job);
+
+typedef enum {
+    WATCH_EVENT_NONE = 0,
+    WATCH_EVENT_BUTTON,     // button holds the BTN_* pin that was pressed
+    WATCH_EVENT_TICK,
+    WATCH_EVENT_WAKE,       // job holds the wake job whose window opened
+    WATCH_EVENT_BUTTON_UP,
+    WATCH_EVENT_LONG_PRESS, // held for about 750 ms
+    WATCH_EVENT_REPEAT,     // still held after a long press, about five times a second
+    WATCH_EVENT_DOUBLE_TAP, // pressed again within about 300 ms of a short press
+    WATCH_EVENT_CHORD,      // pressed while other buttons were down
+    WATCH_EVENT_I2C,        // transaction holds the I2C transaction that completed
+    WATCH_EVENT_ADC,        // button holds the analog pin, value the result of watch_adc_start()
+    WATCH_EVENT_ADC_WINDOW, // button holds the analog pin, value the result that crossed the window
+    WATCH_EVENT_ADC_CAPTURE,// button holds the analog pin, samples the half of the capture buffer just filled
+} watch_event_type_t;
+
+#define WATCH_BUTTON_LIGHT (1 << 0)
+#define WATCH_BUTTON_MODE (1 << 1)
+#define WATCH_BUTTON_ALARM (1 << 2)
+
+typedef struct watch_i2c_transaction watch_i2c_transaction_t;
+
+typedef struct {
+    uint8_t type;
+    uint8_t button;
+    uint8_t buttons;        // WATCH_BUTTON_* mask of the buttons down, for button events
+    union {
+        watch_wake_job_t *job;
+        watch_i2c_transaction_t *transaction;
+        uint16_t value;
+        uint16_t *samples;
+    };
+} watch_event_t;
+
+// Interrupts queue events for main.c to pass to app_handle_event(). Buttons registered with
+// watch_register_button_event(), the tick after watch_enable_tick_events(), and wake jobs
+// scheduled with a NULL callback, and I2C transactions and ADC conversions started without a
+// callback all post here instead of calling back from the interrupt.
+// A button press posts WATCH_EVENT_BUTTON first, then any DOUBLE_TAP or CHORD it completes.
+void watch_enable_tick_events();
+bool watch_get_event(watch_event_t *event);
+bool watch_has_pending_events();
+
 void watch_enable_analog(const uint8_t pin);
 
+// ADC sampling for the pins set up with watch_enable_analog(). Conversions end in the ADC
+// interrupt, which calls back or posts an event; nothing busy-waits, and the ADC runs in STANDBY.
+// Results are 12-bit, averaged in hardware over the samples set with watch_adc_set_averaging().
+typedef void (*watch_adc_cb_t)(uint8_t pin, uint16_t value);
+
+// Has the ADC accumulate samples conversions for every result (rounded down to a power of two,
+// up to 1024) and scale the sum back to 12 bits. 1, the default, turns averaging off.
+void watch_adc_set_averaging(uint16_t samples);
+// Starts one conversion and returns at once; the callback, or WATCH_EVENT_ADC if it is NULL, gets
+// the result. Returns ERR_INVALID_ARG for a pin with no ADC input, or ERR_BUSY while another
+// conversion, a monitor or a capture has the ADC.
+int32_t watch_adc_start(uint8_t pin, watch_adc_cb_t callback);
+// Converts and sleeps until the result is in. Returns 0 if the ADC could not start.
+uint16_t watch_adc_read(uint8_t pin);
+// Converts pin at rate (WATCH_TICK_1_HZ to WATCH_TICK_128_HZ) on the RTC's periodic event,
+// without waking the core, and reports only the results that cross the window: leaving
+// low < value < high, or coming back into it. The monitor starts out inside, so a first result
+// outside the window is reported at once. Calls back or posts WATCH_EVENT_ADC_WINDOW. Calling it
+// again replaces the monitor.
+int32_t watch_adc_monitor(uint8_t pin, uint16_t low, uint16_t high, watch_tick_rate_t rate, watch_adc_cb_t callback);
+void watch_adc_stop_monitor();
+
+// Streams conversions into a ring buffer: the DMAC stores every result, and the core hears only
+// of each half as it fills.
+typedef void (*watch_adc_capture_cb_t)(uint16_t *samples, uint16_t count);
+
+// Converts pin sample_rate times a second (up to 32768) into buffer, over and over. Rates other
+// than the powers of two from 1 to 128 Hz run at the nearest 32768 / n Hz, such as 992 Hz for
+// 1000. The callback, from the DMAC interrupt, or else WATCH_EVENT_ADC_CAPTURE, gets each half as
+// it fills, and has until the other half fills to use it. length must be even, and buffer must
+// outlast the capture. Averaging applies, but all the samples for a result must fit in one sample
+// period. Returns ERR_INVALID_ARG for bad arguments, or ERR_BUSY while a conversion or monitor
+// has the ADC.
+int32_t watch_adc_capture_start(uint8_t pin, uint16_t *buffer, uint16_t length, uint32_t sample_rate, watch_adc_capture_cb_t callback);
+void watch_adc_capture_stop();
+// Returns the rate the running capture converts at, after rounding, or 0 with no capture running.
+uint32_t watch_adc_capture_get_rate();
+
 void watch_enable_buttons();
 void watch_register_button_callback(const uint32_t pin, ext_irq_cb_t callback);
+void watch_register_button_event(const uint32_t pin);
 
 void watch_enable_digital_input(const uint8_t pin);
 void watch_enable_pull_up(const uint8_t pin);
@@ -39,14 +181,93 @@ void watch_enable_digital_output(const uint8_t pin);
 void watch_disable_digital_output(const uint8_t pin);
 void watch_set_pin_level(const uint8_t pin, const bool level);
 
-struct io_descriptor *I2C_0_io;
+extern struct io_descriptor *I2C_0_io;
 
 void watch_enable_i2c();
+// The blocking calls wait for queued transactions to finish, then hold the bus until they return;
+// anything watch_i2c_submit() queues meanwhile starts after them. Call them from the main loop
+// only: an interrupt must submit instead.
 void watch_i2c_send(int16_t addr, uint8_t *buf, uint16_t length);
 void watch_i2c_receive(int16_t addr, uint8_t *buf, uint16_t length);
 
+typedef struct {
+    uint8_t *buf;
+    uint16_t length;
+    bool read;
+} watch_i2c_message_t;
+
+// Runs the messages as one transaction, blocking: each after the first begins with a repeated
+// start, and only the last ends with a stop, so no other master can address the slave in
+// between. Returns I2C_OK, or the I2C_NACK / I2C_ERR_* code of the message that failed.
+int32_t watch_i2c_transfer(int16_t addr, watch_i2c_message_t *messages, uint8_t count);
+// Writes write_length bytes, typically a register pointer, then reads read_length bytes back
+// after a repeated start. Half the bus time of watch_i2c_send() then watch_i2c_receive().
+int32_t watch_i2c_write_read(int16_t addr, uint8_t *write_buf, uint16_t write_length, uint8_t *read_buf,
+                             uint16_t read_length);
+
+typedef void (*watch_i2c_cb_t)(watch_i2c_transaction_t *transaction);
+
+#define WATCH_I2C_PENDING 1
+
+struct watch_i2c_transaction {
+    uint8_t addr;
+    const uint8_t *write_buf;   // sent first, if write_length is nonzero
+    uint16_t write_length;
+    uint8_t *read_buf;          // then filled after a repeated start, if read_length is nonzero
+    uint16_t read_length;
+    watch_i2c_cb_t callback;    // NULL to post WATCH_EVENT_I2C instead
+    volatile int32_t status;    // WATCH_I2C_PENDING, then I2C_OK or an I2C_NACK / I2C_ERR_* code
+    struct watch_i2c_transaction *next;
+};
+
+// Queues a transaction and returns at once; transactions run one after another in the order
+// submitted, driven by the SERCOM interrupt, and the callback runs from that interrupt when one
+// ends. The transaction and its buffers must stay put until then. Reads of 4 to 255 bytes, and
+// writes of that length with no read after them, move through the DMAC rather than taking an
+// interrupt per byte. Safe to call from interrupts. Returns ERR_INVALID_ARG if both lengths are
+// zero.
+int32_t watch_i2c_submit(watch_i2c_transaction_t *transaction);
+bool watch_i2c_is_busy();
+// Sleeps in IDLE until every queued transaction has completed.
+void watch_i2c_wait();
+
+// Debug log on the SERCOM3 UART (TX on PB00), 8N1. Writes never block: they queue in RAM, and
+// the DMAC sends them while the app carries on or sleeps in IDLE. Safe to call from interrupts.
+void watch_enable_log(uint32_t baud);
+// Queues length bytes. Returns false, and counts the message as dropped, if the log is not
+// enabled or the whole message does not fit in the space left.
+bool watch_log_write(const char *buf, uint16_t length);
+// Formats as printf() does, into at most 127 characters, then queues as watch_log_write().
+bool watch_log_printf(const char *format, ...) __attribute__((format(printf, 1, 2)));
+// Returns the number of messages dropped since the log was enabled.
+uint32_t watch_log_get_dropped();
+// Sleeps in IDLE until everything queued has left the UART.
+void watch_log_flush();
+
+// delay_ms() and delay_us() sleep through waits of 2 ms or more, in the mode watch_get_sleep_mode()
+// picks, with a compare on TC0 and TC1's shared 32.768 kHz timebase to wake the core; shorter
+// waits, and any made from an interrupt handler or with interrupts masked, spin on SysTick as
+// before. Each sleeping wait first spends about 150 us awake reading the timebase, unless
+// nothing else is using it.
+
+// Monotonic timestamps for profiling, counted from watch_enable_timestamps() and kept through
+// STANDBY. They keep the timebase running, which adds no wakes of its own in normal use: its
+// 36-hour wraps are counted as the core wakes, and a wake job with a 12-hour window makes sure
+// one comes. While they are on, every wake spends about 150 us at full power reading the
+// timebase; calls then read SysTick and cost about a hundred cycles, except that the first call
+// after 2^24 cycles awake without sleeping reads the timebase again. Both return 0 until
+// timestamps are enabled.
+void watch_enable_timestamps();
+// CPU cycles, at CONF_CPU_FREQUENCY.
+uint64_t watch_cycles();
+uint64_t watch_timestamp_us();
+
 void watch_store_backup_data(uint32_t data, uint8_t reg);
 uint32_t watch_get_backup_data(uint8_t reg);
+// The deepest sleep mode that keeps the peripherals in use clocked: IDLE while an I2C
+// transaction is in flight or the log is sending, STANDBY otherwise. main.c sleeps in it
+// between events.
+uint8_t watch_get_sleep_mode();
 void watch_enter_deep_sleep();
 
 #endif /* WATCH_H_ */
\ No newline at end of file
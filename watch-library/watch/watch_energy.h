@@ -0,0 +1,48 @@
+#ifndef WATCH_ENERGY_H_
+#define WATCH_ENERGY_H_
+
+/**
+  * Energy accounting hooks for the wake / sleep cycle.
+  *
+  * main.c brackets each app callback with WATCH_ENERGY_ENTER / WATCH_ENERGY_EXIT, and the
+  * interrupt dispatcher does the same for each IRQ handler. When WATCH_ENERGY_ACCOUNTING
+  * is defined these record cycle timestamps, which the backend combines with per-peripheral
+  * current figures into a per-wake energy report. Otherwise they compile to nothing.
+  *
+  * The backend currently lives in the host build (watch-library/host/host_energy.c), where
+  * the simulator knows exactly how long the core was awake and which peripherals were on.
+  * Regions are inclusive: an interrupt taken during app_loop counts toward both.
+  */
+
+typedef enum {
+    WATCH_ENERGY_APP_LOOP = 0,
+    WATCH_ENERGY_APP_PREPARE_FOR_SLEEP,
+    WATCH_ENERGY_APP_WAKE_FROM_SLEEP,
+    WATCH_ENERGY_APP_HANDLE_EVENT,
+    WATCH_ENERGY_RTC_HANDLER,
+    WATCH_ENERGY_EIC_HANDLER,
+    WATCH_ENERGY_DMAC_HANDLER,
+    WATCH_ENERGY_SERCOM1_HANDLER,
+    WATCH_ENERGY_ADC_HANDLER,
+    WATCH_ENERGY_SERCOM3_HANDLER,
+    WATCH_ENERGY_TC0_HANDLER,
+    WATCH_ENERGY_TC1_HANDLER,
+    WATCH_ENERGY_NUM_REGIONS
+} watch_energy_region_t;
+
+#ifdef WATCH_ENERGY_ACCOUNTING
+
+void watch_energy_enter(watch_energy_region_t region);
+void watch_energy_exit(watch_energy_region_t region);
+
+#define WATCH_ENERGY_ENTER(region) watch_energy_enter(region)
+#define WATCH_ENERGY_EXIT(region) watch_energy_exit(region)
+
+#else
+
+#define WATCH_ENERGY_ENTER(region) ((void)0)
+#define WATCH_ENERGY_EXIT(region) ((void)0)
+
+#endif
+
+#endif /* WATCH_ENERGY_H_ */
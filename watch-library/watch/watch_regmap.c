@@ -0,0 +1,161 @@
+#include "watch_regmap.h"
+#include <string.h>
+
+// A gap of up to this many cached registers between dirty ones is rewritten rather than split.
+#define WATCH_REGMAP_MAX_GAP 2
+
+// Transfers wait for the I2C queue, so one static buffer serves them all: the register pointer,
+// then the data. Keeping it out of the caller's stack also keeps long bursts DMA-safe.
+static uint8_t regmap_buf[1 + WATCH_REGMAP_MAX_REGISTERS];
+
+static bool _watch_regmap_contains(watch_regmap_t *map, uint16_t reg) {
+    return reg >= map->first && reg - map->first < map->count;
+}
+
+// Whether a register is in the map and may be cached.
+static bool _watch_regmap_cacheable(watch_regmap_t *map, uint16_t reg) {
+    return _watch_regmap_contains(map, reg) && !(map->volatile_registers & (1ull << (reg - map->first)));
+}
+
+static uint64_t _watch_regmap_bits(uint8_t index, uint8_t length) {
+    return (length >= 64 ? UINT64_MAX : (1ull << length) - 1) << index;
+}
+
+// Sends the register pointer and write_length bytes from regmap_buf + 1, then reads read_length
+// bytes back into the same place after a repeated start.
+static int32_t _watch_regmap_transfer(watch_regmap_t *map, uint8_t reg, uint8_t write_length, uint8_t read_length) {
+    watch_i2c_transaction_t transaction = {
+        .addr = map->addr,
+        .write_buf = regmap_buf,
+        .write_length = 1 + write_length,
+        .read_buf = regmap_buf + 1,
+        .read_length = read_length,
+    };
+
+    regmap_buf[0] = reg | (write_length + read_length > 1 ? map->auto_increment : 0);
+    watch_i2c_submit(&transaction);
+    watch_i2c_wait();
+
+    return transaction.status;
+}
+
+void watch_regmap_init(watch_regmap_t *map, uint8_t addr, uint8_t first, uint8_t count, uint64_t volatile_registers) {
+    memset(map, 0, sizeof(watch_regmap_t));
+    map->addr = addr;
+    map->first = first;
+    map->count = count > WATCH_REGMAP_MAX_REGISTERS ? WATCH_REGMAP_MAX_REGISTERS : count;
+    map->volatile_registers = volatile_registers;
+}
+
+uint8_t watch_regmap_read(watch_regmap_t *map, uint8_t reg) {
+    uint8_t value = 0;
+
+    if (_watch_regmap_cacheable(map, reg) && (map->valid & (1ull << (reg - map->first)))) {
+        return map->values[reg - map->first];
+    }
+    watch_regmap_read_burst(map, reg, &value, 1);
+
+    return value;
+}
+
+int32_t watch_regmap_read_burst(watch_regmap_t *map, uint8_t reg, uint8_t *buf, uint8_t length) {
+    bool cached = true;
+    int32_t status;
+
+    if (!length || length > WATCH_REGMAP_MAX_REGISTERS) return ERR_INVALID_ARG;
+
+    for (uint16_t r = reg; r < reg + length && cached; r++) {
+        cached = _watch_regmap_cacheable(map, r) && (map->valid & (1ull << (r - map->first)));
+    }
+    if (cached) {
+        memcpy(buf, map->values + (reg - map->first), length);
+        return I2C_OK;
+    }
+
+    status = _watch_regmap_transfer(map, reg, 0, length);
+    if (status != I2C_OK) return status;
+
+    for (uint16_t r = reg; r < reg + length; r++) {
+        uint64_t bit;
+        if (!_watch_regmap_cacheable(map, r)) continue;
+        bit = 1ull << (r - map->first);
+        // A write not yet flushed is what the register is about to hold.
+        if (map->dirty & bit) {
+            regmap_buf[1 + r - reg] = map->values[r - map->first];
+        } else {
+            map->values[r - map->first] = regmap_buf[1 + r - reg];
+            map->valid |= bit;
+        }
+    }
+    memcpy(buf, regmap_buf + 1, length);
+
+    return I2C_OK;
+}
+
+// Returns the status of the bus write for a register that is not cached, else I2C_OK.
+static int32_t _watch_regmap_write(watch_regmap_t *map, uint8_t reg, uint8_t value) {
+    uint64_t bit;
+
+    if (!_watch_regmap_cacheable(map, reg)) {
+        watch_regmap_flush(map);
+        regmap_buf[1] = value;
+        return _watch_regmap_transfer(map, reg, 1, 0);
+    }
+
+    bit = 1ull << (reg - map->first);
+    if ((map->valid & bit) && map->values[reg - map->first] == value) return I2C_OK;
+    map->values[reg - map->first] = value;
+    map->valid |= bit;
+    map->dirty |= bit;
+
+    return I2C_OK;
+}
+
+void watch_regmap_write(watch_regmap_t *map, uint8_t reg, uint8_t value) {
+    _watch_regmap_write(map, reg, value);
+}
+
+int32_t watch_regmap_update_bits(watch_regmap_t *map, uint8_t reg, uint8_t mask, uint8_t value) {
+    uint8_t current;
+    int32_t status = watch_regmap_read_burst(map, reg, &current, 1);
+
+    // The read leaves nothing to merge into, and writing the bits outside mask as zeros would
+    // cache them as the register's value.
+    if (status != I2C_OK) return status;
+
+    return _watch_regmap_write(map, reg, (current & ~mask) | (value & mask));
+}
+
+int32_t watch_regmap_flush(watch_regmap_t *map) {
+    int32_t status = I2C_OK;
+    uint8_t i = 0;
+
+    while (i < map->count) {
+        uint8_t end = i + 1;
+        int32_t result;
+
+        if (!(map->dirty & (1ull << i))) {
+            i++;
+            continue;
+        }
+        // Extend the burst over later dirty registers, across short runs of cached ones.
+        for (uint8_t j = end; j < map->count && j - end <= WATCH_REGMAP_MAX_GAP; j++) {
+            uint64_t bit = 1ull << j;
+            if (map->dirty & bit) end = j + 1;
+            else if (!(map->valid & bit) || (map->volatile_registers & bit)) break;
+        }
+
+        memcpy(regmap_buf + 1, map->values + i, end - i);
+        result = _watch_regmap_transfer(map, map->first + i, end - i, 0);
+        if (result == I2C_OK) map->dirty &= ~_watch_regmap_bits(i, end - i);
+        else if (status == I2C_OK) status = result;
+        i = end;
+    }
+
+    return status;
+}
+
+void watch_regmap_invalidate(watch_regmap_t *map) {
+    map->valid = 0;
+    map->dirty = 0;
+}
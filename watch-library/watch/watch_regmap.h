@@ -0,0 +1,54 @@
+#ifndef WATCH_REGMAP_H_
+#define WATCH_REGMAP_H_
+#include "watch.h"
+
+/**
+  * Cached register map for an I2C sensor on I2C_0.
+  *
+  * Most sensor configuration registers only change when the firmware writes them, so the map
+  * keeps a shadow copy: reads of a cached register cost nothing, and a write that does not change
+  * the value is dropped. Writes are held as dirty until watch_regmap_flush(), which sends each run
+  * of adjacent dirty registers as one burst; a gap of one or two cached registers is rewritten
+  * rather than split, since a new transaction costs the address, the register pointer and a
+  * start and stop anyway.
+  *
+  * Registers that the sensor changes itself (status, data outputs, FIFO) must be marked volatile.
+  * They are never cached: reads always go to the bus, and writes go through at once, after any
+  * pending dirty writes so that the sensor sees them in program order.
+  *
+  * Bus traffic goes through the I2C queue and waits for it, so these functions sleep and must
+  * not be called from an interrupt or an I2C callback.
+  */
+
+#define WATCH_REGMAP_MAX_REGISTERS 64
+
+typedef struct {
+    uint8_t addr;                   // seven-bit slave address
+    uint8_t first;                  // the lowest register in the map
+    uint8_t count;                  // up to WATCH_REGMAP_MAX_REGISTERS
+    uint8_t auto_increment;         // OR'd into the register pointer of multi-byte transfers (0x80 on ST parts)
+    uint64_t volatile_registers;    // bit n for register first + n
+    uint64_t valid;
+    uint64_t dirty;
+    uint8_t values[WATCH_REGMAP_MAX_REGISTERS];
+} watch_regmap_t;
+
+// Sets up an empty map; nothing is cached until first read or written.
+void watch_regmap_init(watch_regmap_t *map, uint8_t addr, uint8_t first, uint8_t count, uint64_t volatile_registers);
+// Returns a register's value, from the shadow when it holds one. Returns 0 if the read fails.
+uint8_t watch_regmap_read(watch_regmap_t *map, uint8_t reg);
+// Reads length consecutive registers in at most one transaction. Registers outside the map are
+// read from the bus as if volatile. Returns I2C_OK or the I2C queue's error.
+int32_t watch_regmap_read_burst(watch_regmap_t *map, uint8_t reg, uint8_t *buf, uint8_t length);
+// Sets a register in the shadow, to be sent by the next flush; volatile registers go at once.
+void watch_regmap_write(watch_regmap_t *map, uint8_t reg, uint8_t value);
+// Replaces the bits of a register that are set in mask, without a bus read if it is cached.
+// Returns I2C_OK, or the error of the read, in which case nothing is written, or of the write
+// of a volatile register.
+int32_t watch_regmap_update_bits(watch_regmap_t *map, uint8_t reg, uint8_t mask, uint8_t value);
+// Sends every dirty register. Returns I2C_OK or the first error; failed registers stay dirty.
+int32_t watch_regmap_flush(watch_regmap_t *map);
+// Forgets the shadow, e.g. after a sensor reset. Dirty registers are dropped.
+void watch_regmap_invalidate(watch_regmap_t *map);
+
+#endif /* WATCH_REGMAP_H_ */
@@ -0,0 +1,29 @@
+#include "watch_trace.h"
+
+// A 32-bit varint takes at most five bytes.
+#define WATCH_TRACE_VARINT_MAX 5
+
+static uint8_t _watch_trace_varint(uint8_t *out, uint32_t value) {
+    uint8_t length = 0;
+
+    while (value >= 0x80) {
+        out[length++] = (value & 0x7F) | 0x80;
+        value >>= 7;
+    }
+    out[length++] = value;
+
+    return length;
+}
+
+bool watch_trace_write(uint32_t id, const uint32_t *args, uint8_t count) {
+    uint8_t record[2 + WATCH_TRACE_VARINT_MAX * (1 + WATCH_TRACE_MAX_ARGS)];
+    uint8_t length = 2;
+
+    if (count > WATCH_TRACE_MAX_ARGS) return false;
+    length += _watch_trace_varint(record + length, id);
+    for (uint8_t i = 0; i < count; i++) length += _watch_trace_varint(record + length, args[i]);
+    record[0] = WATCH_TRACE_MARKER;
+    record[1] = length - 2;
+
+    return watch_log_write((const char *)record, length);
+}
@@ -0,0 +1,40 @@
+#ifndef WATCH_TRACE_H_
+#define WATCH_TRACE_H_
+#include "watch.h"
+
+/**
+  * Tokenized trace messages on the debug log.
+  *
+  * WATCH_TRACE("tick %u, %d mV", count, millivolts) looks like a printf, but nothing is formatted
+  * on the watch. The format string goes into the .watch_trace section, which the linker script
+  * keeps in the ELF without loading it into flash, and its address there serves as the message's
+  * ID. What goes out on the log is a record of that ID and the raw arguments, a few bytes where
+  * the text would take dozens; utils/trace_decode.py reads the strings back out of the ELF and
+  * formats the records on the host. Records start with a byte that text never contains, so they
+  * can share the log with watch_log_printf().
+  *
+  * Arguments are 32-bit integers, up to WATCH_TRACE_MAX_ARGS of them; the decoder supports the
+  * d, i, u, x, X, o and c conversions with the usual flags and widths. Strings and floating point
+  * cannot be traced. Like every log write, a record that does not fit is dropped whole.
+  *
+  * Wire format: WATCH_TRACE_MARKER, the length of the rest, then the ID and each argument as
+  * base-128 varints, least significant group first.
+  */
+
+#define WATCH_TRACE_MAX_ARGS 8
+#define WATCH_TRACE_MARKER 0xFF
+
+#define WATCH_TRACE(format, ...) \
+    do { \
+        static const char _watch_trace_format[] __attribute__((section(".watch_trace"), used)) = format; \
+        const uint32_t _watch_trace_args[] = { 0, ##__VA_ARGS__ }; \
+        _Static_assert(sizeof(_watch_trace_args) / sizeof(uint32_t) <= WATCH_TRACE_MAX_ARGS + 1, \
+                       "too many trace arguments"); \
+        watch_trace_write((uint32_t)(uintptr_t)_watch_trace_format, _watch_trace_args + 1, \
+                          sizeof(_watch_trace_args) / sizeof(uint32_t) - 1); \
+    } while (0)
+
+// Sends a record; WATCH_TRACE() is the way to call it. Returns false if the log dropped it.
+bool watch_trace_write(uint32_t id, const uint32_t *args, uint8_t count);
+
+#endif /* WATCH_TRACE_H_ */